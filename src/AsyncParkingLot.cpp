@@ -0,0 +1,78 @@
+#include "AsyncParkingLot.h"
+#include <climits>
+
+AsyncParkingLot::AsyncParkingLot(ParkingLot &parkingLot) : lot(&parkingLot) {}
+
+AsyncParkingLot::~AsyncParkingLot() {
+    // The awaiters live in the session frames, so read the handles before destroying
+    std::vector<std::coroutine_handle<>> suspended;
+    for (ParkAwaiter* p : newParks) suspended.push_back(p->handle);
+    for (FindAwaiter* f : newFinds) suspended.push_back(f->handle);
+    for (const auto &entry : queuedParks) suspended.push_back(entry.second->handle);
+    for (std::coroutine_handle<> h : suspended) h.destroy();
+}
+
+AsyncParkingLot::ParkAwaiter AsyncParkingLot::park(int carId) {
+    return ParkAwaiter(this, carId);
+}
+
+AsyncParkingLot::FindAwaiter AsyncParkingLot::find(int carId) {
+    return FindAwaiter(this, carId);
+}
+
+int AsyncParkingLot::tick() {
+    // Take this tick's requests; sessions resumed below start the next batch
+    std::vector<ParkAwaiter*> arrivals;
+    std::vector<FindAwaiter*> lookups;
+    arrivals.swap(newParks);
+    lookups.swap(newFinds);
+    std::vector<std::coroutine_handle<>> ready;
+
+    if (!arrivals.empty()) {
+        std::vector<int> ids;
+        ids.reserve(arrivals.size());
+        for (ParkAwaiter* p : arrivals) ids.push_back(p->carId);
+
+        std::vector<LotStatus> added = lot->addCarsToEntrance(ids.data(), (int)ids.size());
+        for (std::size_t i = 0; i < arrivals.size(); ++i) {
+            if (added[i] == LotStatus::Ok) {
+                queuedParks.emplace(arrivals[i]->carId, arrivals[i]);
+            } else {
+                arrivals[i]->result = ParkResult{added[i], arrivals[i]->carId, 0};
+                ready.push_back(arrivals[i]->handle);
+            }
+        }
+    }
+
+    // One sweep over the free lanes for every queued car that fits
+    if (!queuedParks.empty()) {
+        for (const ParkResult &r : lot->parkBatch(INT_MAX)) {
+            auto it = queuedParks.find(r.carId);
+            if (it == queuedParks.end()) continue;  // queued through ParkingLot directly
+            it->second->result = r;
+            ready.push_back(it->second->handle);
+            queuedParks.erase(it);
+        }
+    }
+
+    for (FindAwaiter* f : lookups) {
+        int stackIndex, position;
+        if (lot->findCar(f->carId, stackIndex, position)) {
+            f->result = FindResult{true, stackIndex, position};
+        }
+        ready.push_back(f->handle);
+    }
+
+    for (std::coroutine_handle<> h : ready) h.resume();
+    return (int)ready.size();
+}
+
+void AsyncParkingLot::runUntilIdle() {
+    do {
+        tick();
+    } while (!newParks.empty() || !newFinds.empty());
+}
+
+int AsyncParkingLot::pending() const {
+    return (int)(newParks.size() + newFinds.size() + queuedParks.size());
+}
@@ -0,0 +1,128 @@
+#ifndef ASYNCPARKINGLOT_H
+#define ASYNCPARKINGLOT_H
+#include "ParkingLot.h"
+#include <coroutine>
+#include <exception>
+#include <unordered_map>
+#include <vector>
+
+// Coroutine front end for gate controllers (C++20). A gate session is a
+// coroutine that awaits lot operations instead of blocking a thread:
+//
+//   AsyncParkingLot::Session gate(AsyncParkingLot &lot, int carId) {
+//       ParkResult parked = co_await lot.park(carId);
+//       FindResult where = co_await lot.find(carId);
+//       ...
+//   }
+//
+// Requests are only recorded when awaited; tick() serves them in batches on
+// the calling thread. All parks of a tick enter the lot with one
+// addCarsToEntrance call and are placed by one parkBatch sweep, so thousands
+// of sessions need neither a thread each nor a lane search each.
+// A park whose car cannot be placed yet (every stack full) stays pending and
+// is served by a later tick once space frees up.
+//
+// async_gate.cpp drives it end to end (build line there).
+//
+// Single-threaded: create, await and tick from one thread. While parks are
+// pending, take cars off the entrance only through this object (not through
+// ParkingLot's own park methods), or those sessions never resume.
+class AsyncParkingLot {
+public:
+    // Fire-and-forget coroutine type for gate sessions. It starts running
+    // immediately and frees itself when it finishes.
+    struct Session {
+        struct promise_type {
+            Session get_return_object() noexcept { return Session(); }
+            std::suspend_never initial_suspend() noexcept { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() noexcept {}
+            void unhandled_exception() noexcept { std::terminate(); }
+        };
+    };
+
+    // Awaitable returned by park(); resumes with the ParkResult
+    class ParkAwaiter {
+    private:
+        friend class AsyncParkingLot;
+        AsyncParkingLot* owner;
+        int carId;
+        ParkResult result;
+        std::coroutine_handle<> handle;
+
+    public:
+        ParkAwaiter(AsyncParkingLot* lot, int id)
+            : owner(lot), carId(id), result{LotStatus::Ok, id, 0} {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            owner->newParks.push_back(this);
+        }
+        ParkResult await_resume() const noexcept { return result; }
+    };
+
+    // Awaitable returned by find(); resumes with the FindResult
+    class FindAwaiter {
+    private:
+        friend class AsyncParkingLot;
+        AsyncParkingLot* owner;
+        int carId;
+        FindResult result;
+        std::coroutine_handle<> handle;
+
+    public:
+        FindAwaiter(AsyncParkingLot* lot, int id)
+            : owner(lot), carId(id), result{false, 0, 0} {}
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            handle = h;
+            owner->newFinds.push_back(this);
+        }
+        FindResult await_resume() const noexcept { return result; }
+    };
+
+private:
+    ParkingLot* lot;
+    std::vector<ParkAwaiter*> newParks;   // awaited since the last tick
+    std::vector<FindAwaiter*> newFinds;
+    std::unordered_map<int, ParkAwaiter*> queuedParks;  // car in the entrance queue
+
+    AsyncParkingLot(const AsyncParkingLot&) = delete;
+    AsyncParkingLot& operator=(const AsyncParkingLot&) = delete;
+
+public:
+    // The lot is not owned and must outlive this object.
+    // Time Complexity: O(1)
+    explicit AsyncParkingLot(ParkingLot &parkingLot);
+
+    // Destroys the sessions that are still suspended here.
+    // Time Complexity: O(w) for w waiting sessions
+    ~AsyncParkingLot();
+
+    // Add carId at the entrance and park it in the first available stack.
+    // Resumes with DuplicateCar, or Ok and the stack once the car is parked.
+    // Time Complexity: O(1) to await
+    ParkAwaiter park(int carId);
+
+    // Look the car up (same answer as ParkingLot::findCar).
+    // Time Complexity: O(1) to await
+    FindAwaiter find(int carId);
+
+    // Serve everything awaited since the last tick, plus queued parks that
+    // now fit, then resume those sessions. Requests made by the resumed
+    // sessions wait for the next tick. Returns the number of sessions resumed.
+    // Time Complexity: O(r + q + l * log_64 n) for r new requests, q queued
+    // cars parked, l lanes filled
+    int tick();
+
+    // tick() until no request is left that a tick could serve now.
+    // Parks waiting for space stay pending.
+    // Time Complexity: O(total work of the ticks)
+    void runUntilIdle();
+
+    // Sessions waiting on this object.
+    // Time Complexity: O(1)
+    int pending() const;
+};
+
+#endif // ASYNCPARKINGLOT_H
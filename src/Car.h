@@ -1,5 +1,6 @@
 #ifndef CAR_H
 #define CAR_H
+#include <cstddef>
 
 // Basic car node used in both Stack and Queue
 struct Car {
@@ -7,7 +8,11 @@ struct Car {
     Car* next;
 
     Car(int id = 0) : carId(id), next(nullptr) {}
+
+    // Nodes are carved from CarPool (see CarPool.h) instead of the general heap,
+    // so a delete followed by a new reuses the same node without malloc/free.
+    static void* operator new(std::size_t size);
+    static void operator delete(void* p, std::size_t size) noexcept;
 };
 
 #endif // CAR_H
-
@@ -0,0 +1,129 @@
+#include "CarIndex.h"
+#include <cstdint>
+#include <utility>
+
+static const std::size_t MIN_ENTRIES = 16;
+
+CarIndex::CarIndex() : entries(nullptr), mask(0), shift(64), count(0) {}
+
+CarIndex::~CarIndex() {
+    delete [] entries;
+}
+
+std::size_t CarIndex::home(int carId) const {
+    // Fibonacci hashing: the top bits of the product are well mixed even
+    // for sequential IDs
+    return (std::size_t)(((std::uint64_t)(std::uint32_t)carId * 0x9E3779B97F4A7C15ull) >> shift);
+}
+
+std::size_t CarIndex::probe(int carId) const {
+    std::size_t i = home(carId);
+    while (entries[i].location.lane != FREE && entries[i].carId != carId) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+void CarIndex::rehash(std::size_t entryCount) {
+    Entry* old = entries;
+    std::size_t oldCount = old != nullptr ? mask + 1 : 0;
+
+    entries = new Entry[entryCount];
+    mask = entryCount - 1;
+    shift = 64;
+    for (std::size_t n = entryCount; n > 1; n >>= 1) --shift;
+    for (std::size_t i = 0; i < entryCount; ++i) entries[i].location.lane = FREE;
+
+    for (std::size_t i = 0; i < oldCount; ++i) {
+        if (old[i].location.lane != FREE) entries[probe(old[i].carId)] = old[i];
+    }
+    delete [] old;
+}
+
+void CarIndex::reserve(std::size_t n) {
+    // Keep the load factor at or below 3/4
+    std::size_t needed = MIN_ENTRIES;
+    while (needed / 4 * 3 < n) needed <<= 1;
+    if (entries == nullptr || needed > mask + 1) rehash(needed);
+}
+
+void CarIndex::growIfFull() {
+    if (entries == nullptr) {
+        rehash(MIN_ENTRIES);
+    } else if (count + 1 > (mask + 1) / 4 * 3) {
+        rehash((mask + 1) * 2);
+    }
+}
+
+bool CarIndex::insert(int carId, const CarLocation &location) {
+    growIfFull();
+    std::size_t i = probe(carId);
+    if (entries[i].location.lane != FREE) return false;
+    entries[i].carId = carId;
+    entries[i].location = location;
+    ++count;
+    return true;
+}
+
+void CarIndex::set(int carId, const CarLocation &location) {
+    growIfFull();
+    std::size_t i = probe(carId);
+    if (entries[i].location.lane == FREE) {
+        entries[i].carId = carId;
+        ++count;
+    }
+    entries[i].location = location;
+}
+
+CarLocation* CarIndex::find(int carId) {
+    if (count == 0) return nullptr;
+    std::size_t i = probe(carId);
+    return entries[i].location.lane != FREE ? &entries[i].location : nullptr;
+}
+
+const CarLocation* CarIndex::find(int carId) const {
+    if (count == 0) return nullptr;
+    std::size_t i = probe(carId);
+    return entries[i].location.lane != FREE ? &entries[i].location : nullptr;
+}
+
+bool CarIndex::erase(int carId) {
+    if (count == 0) return false;
+    std::size_t hole = probe(carId);
+    if (entries[hole].location.lane == FREE) return false;
+
+    // Backward shift: pull later entries of the run into the hole unless
+    // their home lies cyclically after the hole (they would become unreachable)
+    std::size_t j = hole;
+    for (;;) {
+        j = (j + 1) & mask;
+        if (entries[j].location.lane == FREE) break;
+        std::size_t k = home(entries[j].carId);
+        bool stays = hole <= j ? (hole < k && k <= j) : (hole < k || k <= j);
+        if (!stays) {
+            entries[hole] = entries[j];
+            hole = j;
+        }
+    }
+    entries[hole].location.lane = FREE;
+    --count;
+    return true;
+}
+
+std::size_t CarIndex::size() const {
+    return count;
+}
+
+void CarIndex::clear() {
+    if (entries != nullptr) {
+        for (std::size_t i = 0; i <= mask; ++i) entries[i].location.lane = FREE;
+    }
+    count = 0;
+}
+
+void CarIndex::swap(CarIndex &other) {
+    std::swap(entries, other.entries);
+    std::swap(mask, other.mask);
+    std::swap(shift, other.shift);
+    std::swap(count, other.count);
+}
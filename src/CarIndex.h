@@ -0,0 +1,86 @@
+#ifndef CARINDEX_H
+#define CARINDEX_H
+#include <cstddef>
+
+// Where a car currently is.
+// lane == -1 means the entrance queue; otherwise slot is the car's depth
+// counted from the bottom of that lane (0 = bottom), which stays valid while
+// cars above it are pushed or popped.
+struct CarLocation {
+    int lane;
+    int slot;
+};
+
+// Hash map carId -> CarLocation with open addressing (linear probing) in one
+// flat array: no allocation per car, and a lookup usually touches a single
+// cache line. Erase shifts later entries back, so no tombstones build up.
+// Not synchronized; ParkingLot guards it with indexLock.
+class CarIndex {
+private:
+    struct Entry {
+        int carId;
+        CarLocation location;  // location.lane == FREE marks an unused entry
+    };
+    static const int FREE = -2;
+
+    Entry* entries;
+    std::size_t mask;   // entry count - 1 (entry count is a power of two)
+    int shift;          // 64 - log2(entry count), for the multiplicative hash
+    std::size_t count;
+
+    CarIndex(const CarIndex&) = delete;
+    CarIndex& operator=(const CarIndex&) = delete;
+
+    // Time Complexity: O(1)
+    std::size_t home(int carId) const;
+
+    // Time Complexity: O(n)
+    void rehash(std::size_t entryCount);
+
+    // Make room for one more car (load factor at most 3/4).
+    // Time Complexity: O(1), O(n) when the table doubles
+    void growIfFull();
+
+    // Entry holding carId, or the free entry where it would go.
+    // Time Complexity: O(1) expected
+    std::size_t probe(int carId) const;
+
+public:
+    // Time Complexity: O(1)
+    CarIndex();
+
+    // Time Complexity: O(1)
+    ~CarIndex();
+
+    // Add carId; false (and nothing changed) if it is already present.
+    // Time Complexity: O(1) expected, amortized over growth
+    bool insert(int carId, const CarLocation &location);
+
+    // Add carId or overwrite its location.
+    // Time Complexity: O(1) expected, amortized over growth
+    void set(int carId, const CarLocation &location);
+
+    // nullptr if carId is absent. The pointer is valid until the next insert,
+    // set or erase; updating the location through it is allowed.
+    // Time Complexity: O(1) expected
+    CarLocation* find(int carId);
+    const CarLocation* find(int carId) const;
+
+    // Time Complexity: O(1) expected
+    bool erase(int carId);
+
+    // Make room for n cars without further growth.
+    // Time Complexity: O(n)
+    void reserve(std::size_t n);
+
+    // Time Complexity: O(1)
+    std::size_t size() const;
+
+    // Time Complexity: O(capacity)
+    void clear();
+
+    // Time Complexity: O(1)
+    void swap(CarIndex &other);
+};
+
+#endif // CARINDEX_H
@@ -0,0 +1,233 @@
+#include "CarPool.h"
+#include "Car.h"
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace {
+
+// A free node reuses the storage of a Car
+struct FreeNode {
+    FreeNode* next;
+};
+
+const std::size_t NODE_SIZE =
+    sizeof(Car) > sizeof(FreeNode) ? sizeof(Car) : sizeof(FreeNode);
+
+// Shared by all threads. The mutex guards slabs and depot only; the
+// counters are atomics so the hot path takes no lock.
+struct PoolState {
+    std::mutex lock;
+    std::vector<char*> slabs;
+    FreeNode* depot = nullptr;    // nodes spilled by busy freeing threads or left by exited ones
+    FreeNode* depotTail = nullptr;
+    std::size_t depotCount = 0;
+    std::atomic<std::size_t> slabCount{0};
+    std::atomic<std::size_t> inUse{0};
+    std::atomic<std::size_t> highWater{0};
+    std::atomic<std::size_t> allocations{0};
+};
+
+// Intentionally never destroyed: Cars owned by static objects may be
+// released during static destruction, after a function-local static would be gone.
+PoolState& state() {
+    static PoolState* s = new PoolState();
+    return *s;
+}
+
+// Per-thread free list and slab cursor. Trivially destructible, so it stays
+// usable during static destruction; CacheFlusher hands its nodes to the depot
+// when the thread exits.
+struct ThreadCache {
+    FreeNode* freeList;
+    FreeNode* freeTail;     // last node of freeList, so it splices in O(1)
+    std::size_t freeCount;  // length of freeList
+    char* slabCursor;   // next never-used node in this thread's newest slab
+    char* slabEnd;
+    bool flushed;       // thread is exiting: release straight to the depot
+    bool registered;
+};
+
+thread_local ThreadCache cache = {nullptr, nullptr, 0, nullptr, nullptr, false, false};
+
+void flushToDepot(ThreadCache &c) {
+    // Carve what is left of the slab so no node is stranded
+    for (; c.slabCursor != c.slabEnd; c.slabCursor += NODE_SIZE) {
+        FreeNode* f = reinterpret_cast<FreeNode*>(c.slabCursor);
+        f->next = c.freeList;
+        if (c.freeList == nullptr) c.freeTail = f;
+        c.freeList = f;
+        ++c.freeCount;
+    }
+    if (c.freeList == nullptr) return;
+
+    PoolState &s = state();
+    std::lock_guard<std::mutex> guard(s.lock);
+    c.freeTail->next = s.depot;
+    if (s.depot == nullptr) s.depotTail = c.freeTail;
+    s.depot = c.freeList;
+    s.depotCount += c.freeCount;
+    c.freeList = nullptr;
+    c.freeTail = nullptr;
+    c.freeCount = 0;
+}
+
+// Free lists longer than this spill SPILL_NODES nodes to the depot. Without
+// the cap, a thread that only frees (an exit gate) would hoard every node
+// while the allocating thread kept carving new slabs.
+const std::size_t FREE_LIST_CAP = 2 * CarPool::SLAB_NODES;
+const std::size_t SPILL_NODES = CarPool::SLAB_NODES;
+
+// Takes from the front; the list stays non-empty, so freeTail is unchanged.
+// Time Complexity: O(SPILL_NODES), once per SPILL_NODES releases
+void spillToDepot(ThreadCache &c) {
+    FreeNode* first = c.freeList;
+    FreeNode* last = first;
+    for (std::size_t i = 1; i < SPILL_NODES; ++i) last = last->next;
+    c.freeList = last->next;
+    c.freeCount -= SPILL_NODES;
+
+    PoolState &s = state();
+    std::lock_guard<std::mutex> guard(s.lock);
+    last->next = s.depot;
+    if (s.depot == nullptr) s.depotTail = last;
+    s.depot = first;
+    s.depotCount += SPILL_NODES;
+}
+
+struct CacheFlusher {
+    ~CacheFlusher() {
+        flushToDepot(cache);
+        cache.flushed = true;
+    }
+};
+
+thread_local CacheFlusher flusher;
+
+// One node from this thread's free list or slab (refilled under the pool lock)
+void* takeNode(PoolState &s, ThreadCache &c) {
+    if (c.freeList != nullptr) {
+        void* node = c.freeList;
+        c.freeList = c.freeList->next;
+        if (c.freeList == nullptr) c.freeTail = nullptr;
+        --c.freeCount;
+        return node;
+    }
+    if (!c.registered) {
+        (void)&flusher;  // constructs the per-thread flusher
+        c.registered = true;
+    }
+    FreeNode* reuse = nullptr;
+    FreeNode* reuseTail = nullptr;
+    std::size_t reuseCount = 0;
+    {
+        std::lock_guard<std::mutex> guard(s.lock);
+        if (s.depot != nullptr) {
+            reuse = s.depot;  // adopt the whole depot list
+            reuseTail = s.depotTail;
+            reuseCount = s.depotCount;
+            s.depot = nullptr;
+            s.depotTail = nullptr;
+            s.depotCount = 0;
+        } else if (c.slabCursor == c.slabEnd) {
+            char* slab = static_cast<char*>(::operator new(NODE_SIZE * CarPool::SLAB_NODES));
+            s.slabs.push_back(slab);
+            s.slabCount.store(s.slabs.size(), std::memory_order_relaxed);
+            c.slabCursor = slab;
+            c.slabEnd = slab + NODE_SIZE * CarPool::SLAB_NODES;
+        }
+    }
+    if (reuse != nullptr) {
+        c.freeList = reuse->next;
+        c.freeTail = c.freeList != nullptr ? reuseTail : nullptr;
+        c.freeCount = reuseCount - 1;
+        return reuse;
+    }
+    void* node = c.slabCursor;
+    c.slabCursor += NODE_SIZE;
+    return node;
+}
+
+void countAllocated(PoolState &s, std::size_t n) {
+    s.allocations.fetch_add(n, std::memory_order_relaxed);
+    std::size_t now = s.inUse.fetch_add(n, std::memory_order_relaxed) + n;
+    std::size_t high = s.highWater.load(std::memory_order_relaxed);
+    while (now > high &&
+           !s.highWater.compare_exchange_weak(high, now, std::memory_order_relaxed)) {
+    }
+}
+
+} // namespace
+
+void* CarPool::allocate() {
+    PoolState &s = state();
+    void* node = takeNode(s, cache);
+    countAllocated(s, 1);
+    return node;
+}
+
+void CarPool::allocateBatch(void** out, std::size_t n) {
+    PoolState &s = state();
+    ThreadCache &c = cache;
+    for (std::size_t i = 0; i < n; ++i) out[i] = takeNode(s, c);
+    countAllocated(s, n);
+}
+
+void CarPool::release(void* node) noexcept {
+    if (node == nullptr) return;
+    PoolState &s = state();
+    FreeNode* f = static_cast<FreeNode*>(node);
+    if (cache.flushed) {
+        std::lock_guard<std::mutex> guard(s.lock);
+        f->next = s.depot;
+        if (s.depot == nullptr) s.depotTail = f;
+        s.depot = f;
+        ++s.depotCount;
+    } else {
+        // Nodes freed by a thread other than the allocating one simply join
+        // this thread's list: all nodes are the same size and slabs are never
+        // freed. Past FREE_LIST_CAP a batch goes back to the depot for reuse.
+        f->next = cache.freeList;
+        if (cache.freeList == nullptr) cache.freeTail = f;
+        cache.freeList = f;
+        if (++cache.freeCount > FREE_LIST_CAP) spillToDepot(cache);
+    }
+    s.inUse.fetch_sub(1, std::memory_order_relaxed);
+}
+
+std::size_t CarPool::inUse() {
+    return state().inUse.load(std::memory_order_relaxed);
+}
+
+std::size_t CarPool::highWaterMark() {
+    return state().highWater.load(std::memory_order_relaxed);
+}
+
+void CarPool::resetHighWaterMark() {
+    PoolState &s = state();
+    s.highWater.store(s.inUse.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+std::size_t CarPool::totalAllocations() {
+    return state().allocations.load(std::memory_order_relaxed);
+}
+
+std::size_t CarPool::slabCount() {
+    return state().slabCount.load(std::memory_order_relaxed);
+}
+
+// --- Car allocation goes through the pool ---
+
+void* Car::operator new(std::size_t size) {
+    if (size != sizeof(Car)) return ::operator new(size);
+    return CarPool::allocate();
+}
+
+void Car::operator delete(void* p, std::size_t size) noexcept {
+    if (size != sizeof(Car)) {
+        ::operator delete(p);
+        return;
+    }
+    CarPool::release(p);
+}
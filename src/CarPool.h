@@ -0,0 +1,47 @@
+#ifndef CARPOOL_H
+#define CARPOOL_H
+#include <cstddef>
+
+// Fixed-size slab allocator for Car nodes, shared by Stack and Queue.
+// Freed nodes go on a free list and are handed out again before a new slab
+// is requested. Slabs are never returned to the system.
+// Thread-safe: each thread keeps its own free list and slab, so the common
+// path takes no lock. A thread holding more than 2 * SLAB_NODES free nodes
+// hands a slab's worth to a shared depot, as do exiting threads, so nodes
+// freed on one thread are reused by threads that allocate.
+class CarPool {
+public:
+    // Nodes per slab (one general-heap allocation each)
+    static const std::size_t SLAB_NODES = 4096;
+
+    // Time Complexity: O(1) (amortized; a new slab is carved every SLAB_NODES nodes)
+    static void* allocate();
+
+    // Hand out n nodes at once into out, updating the statistics once.
+    // Time Complexity: O(n)
+    static void allocateBatch(void** out, std::size_t n);
+
+    // Time Complexity: O(1) (amortized; a batch spills every SLAB_NODES releases past the cap)
+    static void release(void* node) noexcept;
+
+    // Nodes currently handed out.
+    // Time Complexity: O(1)
+    static std::size_t inUse();
+
+    // Largest inUse() seen since start (or the last resetHighWaterMark()).
+    // Time Complexity: O(1)
+    static std::size_t highWaterMark();
+
+    // Time Complexity: O(1)
+    static void resetHighWaterMark();
+
+    // Total allocate() calls since start.
+    // Time Complexity: O(1)
+    static std::size_t totalAllocations();
+
+    // Slabs obtained from the general heap so far.
+    // Time Complexity: O(1)
+    static std::size_t slabCount();
+};
+
+#endif // CARPOOL_H
@@ -0,0 +1,87 @@
+#include "FreeLaneSet.h"
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+// Index of the lowest set bit; word must be non-zero
+static inline int lowestBit(uint64_t word) {
+#if defined(_MSC_VER)
+    unsigned long idx;
+    _BitScanForward64(&idx, word);
+    return (int)idx;
+#else
+    return __builtin_ctzll(word);
+#endif
+}
+
+FreeLaneSet::FreeLaneSet(int nLanes) : numLanes(0) {
+    reset(nLanes);
+}
+
+void FreeLaneSet::reset(int nLanes) {
+    numLanes = nLanes < 0 ? 0 : nLanes;
+    levels.clear();
+
+    size_t words = ((size_t)numLanes + 63) / 64;
+    if (words == 0) words = 1;
+    levels.push_back(std::vector<uint64_t>(words, 0));
+    while (words > 1) {
+        words = (words + 63) / 64;
+        levels.push_back(std::vector<uint64_t>(words, 0));
+    }
+}
+
+void FreeLaneSet::set(int lane, bool isFree) {
+    size_t pos = (size_t)lane;
+    for (size_t L = 0; L < levels.size(); ++L) {
+        uint64_t &word = levels[L][pos >> 6];
+        uint64_t bit = 1ULL << (pos & 63);
+        bool wasEmpty = word == 0;
+        if (isFree) {
+            word |= bit;
+        } else {
+            word &= ~bit;
+        }
+        // The parent bit only changes when this word switches between zero and non-zero
+        if (wasEmpty == (word == 0)) break;
+        pos >>= 6;
+    }
+}
+
+bool FreeLaneSet::test(int lane) const {
+    return (levels[0][(size_t)lane >> 6] >> (lane & 63)) & 1;
+}
+
+int FreeLaneSet::findFirst() const {
+    return findNext(0);
+}
+
+int FreeLaneSet::findNext(int from) const {
+    if (from < 0) from = 0;
+    if (from >= numLanes) return -1;
+
+    // Climb until some word holds a set bit at or after pos
+    size_t pos = (size_t)from;
+    size_t L = 0;
+    for (;;) {
+        const std::vector<uint64_t> &level = levels[L];
+        size_t w = pos >> 6;
+        if (w < level.size()) {
+            uint64_t bits = level[w] & (~0ULL << (pos & 63));
+            if (bits != 0) {
+                pos = (w << 6) + lowestBit(bits);
+                break;
+            }
+        }
+        if (L + 1 == levels.size()) return -1;
+        pos = w + 1;  // continue with the next word of this level
+        ++L;
+    }
+
+    // Descend: a summary bit guarantees a non-zero word below it
+    while (L > 0) {
+        --L;
+        pos = (pos << 6) + lowestBit(levels[L][pos]);
+    }
+    return (int)pos;
+}
@@ -0,0 +1,39 @@
+#ifndef FREELANESET_H
+#define FREELANESET_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of lane indices (0-based) that still have free space.
+// Stored as a hierarchical bitset: level 0 has one bit per lane, and every
+// level above has one bit per non-zero 64-bit word of the level below, so
+// "first free lane at or after i" needs one word probe per level.
+class FreeLaneSet {
+private:
+    int numLanes;
+    std::vector<std::vector<uint64_t>> levels;  // levels[0] = one bit per lane
+
+public:
+    // Time Complexity: O(n) (all lanes start as not free)
+    FreeLaneSet(int nLanes = 0);
+
+    // Time Complexity: O(n)
+    void reset(int nLanes);
+
+    // Mark a lane free (true) or full (false).
+    // Time Complexity: O(log_64 n)
+    void set(int lane, bool isFree);
+
+    // Time Complexity: O(1)
+    bool test(int lane) const;
+
+    // Lowest free lane index, or -1 if every lane is full.
+    // Time Complexity: O(log_64 n)
+    int findFirst() const;
+
+    // Lowest free lane index >= from, or -1 if there is none.
+    // Time Complexity: O(log_64 n)
+    int findNext(int from) const;
+};
+
+#endif // FREELANESET_H
@@ -0,0 +1,380 @@
+#include "Journal.h"
+#include <chrono>
+#include <climits>
+#include <cstring>
+
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#include <sys/stat.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const char JOURNAL_MAGIC[4] = {'P', 'L', 'J', 'N'};
+const std::uint32_t JOURNAL_VERSION = 1;
+const std::uint32_t BYTE_ORDER_MARK = 0x01020304;  // reads differently on a foreign-endian host
+const std::size_t HEADER_WORDS = 7;
+const std::size_t HEADER_BYTES = HEADER_WORDS * sizeof(std::uint32_t);
+const std::size_t FRAME_HEADER_BYTES = 2 * sizeof(std::uint32_t);  // byteCount crc32
+
+// ** Thin file layer: unbuffered descriptor I/O, appending writes **
+
+#if defined(_WIN32)
+
+int openFile(const char* path) {
+    return _open(path, _O_RDWR | _O_CREAT | _O_APPEND | _O_BINARY, _S_IREAD | _S_IWRITE);
+}
+
+void closeFile(int fd) {
+    _close(fd);
+}
+
+bool writeAll(int fd, const unsigned char* p, std::size_t n) {
+    while (n > 0) {
+        int written = _write(fd, p, n > (std::size_t)INT_MAX ? (unsigned)INT_MAX : (unsigned)n);
+        if (written <= 0) return false;
+        p += written;
+        n -= (std::size_t)written;
+    }
+    return true;
+}
+
+bool readAll(int fd, std::vector<unsigned char> &out) {
+    out.clear();
+    if (_lseeki64(fd, 0, SEEK_SET) != 0) return false;
+    unsigned char block[1 << 16];
+    int n;
+    while ((n = _read(fd, block, sizeof(block))) > 0) out.insert(out.end(), block, block + n);
+    return n == 0;
+}
+
+bool syncFile(int fd) {
+    return _commit(fd) == 0;
+}
+
+bool truncateFile(int fd, std::size_t size) {
+    return _chsize_s(fd, (long long)size) == 0;
+}
+
+#else
+
+int openFile(const char* path) {
+    return open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+}
+
+void closeFile(int fd) {
+    close(fd);
+}
+
+bool writeAll(int fd, const unsigned char* p, std::size_t n) {
+    while (n > 0) {
+        ssize_t written = write(fd, p, n);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        p += written;
+        n -= (std::size_t)written;
+    }
+    return true;
+}
+
+bool readAll(int fd, std::vector<unsigned char> &out) {
+    out.clear();
+    if (lseek(fd, 0, SEEK_SET) != 0) return false;
+    unsigned char block[1 << 16];
+    for (;;) {
+        ssize_t n = read(fd, block, sizeof(block));
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) return false;
+        if (n == 0) return true;
+        out.insert(out.end(), block, block + n);
+    }
+}
+
+bool syncFile(int fd) {
+#if defined(__linux__)
+    return fdatasync(fd) == 0;  // the size is data too; skips pure metadata like mtime
+#else
+    return fsync(fd) == 0;
+#endif
+}
+
+bool truncateFile(int fd, std::size_t size) {
+    return ftruncate(fd, (off_t)size) == 0;
+}
+
+#endif
+
+// ** CRC-32 (IEEE), one table lookup per byte **
+
+struct CrcTable {
+    std::uint32_t entries[256];
+
+    CrcTable() {
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int bit = 0; bit < 8; ++bit) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            entries[i] = c;
+        }
+    }
+};
+
+std::uint32_t crc32(const unsigned char* data, std::size_t n) {
+    static const CrcTable table;
+    std::uint32_t c = 0xFFFFFFFFu;
+    for (std::size_t i = 0; i < n; ++i) c = table.entries[(c ^ data[i]) & 0xFF] ^ (c >> 8);
+    return c ^ 0xFFFFFFFFu;
+}
+
+// Reads the header; false if bytes do not start with a journal for this shape
+bool readHeader(const std::vector<unsigned char> &bytes, int numStacks, int stackCapacity,
+                std::uint64_t &base) {
+    if (bytes.size() < HEADER_BYTES) return false;
+    std::uint32_t words[HEADER_WORDS];
+    std::memcpy(words, bytes.data(), HEADER_BYTES);
+    if (std::memcmp(&words[0], JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+        words[1] != JOURNAL_VERSION || words[2] != BYTE_ORDER_MARK ||
+        words[3] != (std::uint32_t)numStacks || words[4] != (std::uint32_t)stackCapacity) {
+        return false;
+    }
+    base = (std::uint64_t)words[5] | ((std::uint64_t)words[6] << 32);
+    return true;
+}
+
+// Walks the frames after the header, calling visit for each record of every
+// intact frame. Stops at the first frame that is incomplete or fails its CRC,
+// and returns the offset where it starts (= end of the intact part). Also
+// stops at a frame that passes its CRC but does not decode, setting
+// undecodable: that frame was written whole, by a build that knows ops this
+// one does not, and must not be mistaken for a torn tail. records receives
+// the number of records visited.
+template <class Visit>
+std::size_t scanFrames(const std::vector<unsigned char> &bytes, std::uint64_t &records,
+                       bool &undecodable, Visit visit) {
+    records = 0;
+    undecodable = false;
+    if (bytes.size() < HEADER_BYTES) return 0;
+    std::size_t at = HEADER_BYTES;
+    while (bytes.size() - at >= FRAME_HEADER_BYTES) {
+        std::uint32_t header[2];
+        std::memcpy(header, &bytes[at], sizeof(header));
+        std::size_t length = header[0];
+        if (length == 0 || length > bytes.size() - at - FRAME_HEADER_BYTES) break;
+        const unsigned char* begin = &bytes[at + FRAME_HEADER_BYTES];
+        const unsigned char* end = begin + length;
+        if (crc32(begin, length) != header[1]) break;
+
+        // Decode the whole frame before visiting any of it
+        std::uint64_t count = 0;
+        TraceRecord record;
+        const unsigned char* p = begin;
+        while (p != end && readTraceRecord(p, end, record)) ++count;
+        if (p != end) {
+            undecodable = true;
+            break;
+        }
+
+        for (p = begin; p != end; ) {
+            readTraceRecord(p, end, record);
+            visit(record);
+        }
+        records += count;
+        at += FRAME_HEADER_BYTES + length;
+    }
+    return at;
+}
+
+} // namespace
+
+Journal::Journal(const char* journalPath, int stacks, int capacity, const JournalConfig &journalConfig)
+    : config(journalConfig),
+      fd(openFile(journalPath)),
+      numStacks(stacks),
+      stackCapacity(capacity),
+      baseSequence(0),
+      nextSequence(0),
+      unsynced(0),
+      failed(false),
+      stopping(false) {
+    frame.reserve(FRAME_HEADER_BYTES + config.writeBufferBytes + 16);
+    frame.resize(FRAME_HEADER_BYTES);
+    writing.reserve(frame.capacity());
+    if (fd < 0) {
+        failed = true;
+        return;
+    }
+
+    std::vector<unsigned char> bytes;
+    if (!readAll(fd, bytes)) {
+        failed = true;
+    } else if (bytes.size() < HEADER_BYTES) {
+        // New, or torn while its header was written (before any record)
+        failed = !writeHeader(0);
+    } else if (!readHeader(bytes, numStacks, stackCapacity, baseSequence)) {
+        failed = true;  // not a journal, or for another shape or version: leave it alone
+    } else {
+        std::uint64_t records;
+        bool undecodable;
+        std::size_t intact = scanFrames(bytes, records, undecodable, [](const TraceRecord&) {});
+        nextSequence = baseSequence + records;
+        if (undecodable) {
+            failed = true;  // cutting it off would lose committed work
+        } else if (intact < bytes.size() && (!truncateFile(fd, intact) || !syncFile(fd))) {
+            failed = true;
+        }
+    }
+
+    if (!failed && config.groupCommitMillis > 0) committer = std::thread(&Journal::commitLoop, this);
+}
+
+Journal::~Journal() {
+    if (committer.joinable()) {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        committer.join();
+    }
+    if (fd < 0) return;
+    writeOut(true);
+    closeFile(fd);
+}
+
+void Journal::commitLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+    while (!stopping) {
+        wake.wait_for(guard, std::chrono::milliseconds(config.groupCommitMillis));
+        if (stopping || unsynced == 0 || failed) continue;
+        guard.unlock();
+        writeOut(true);
+        guard.lock();
+    }
+}
+
+bool Journal::writeHeader(std::uint64_t base) {
+    std::uint32_t words[HEADER_WORDS];
+    std::memcpy(&words[0], JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    words[1] = JOURNAL_VERSION;
+    words[2] = BYTE_ORDER_MARK;
+    words[3] = (std::uint32_t)numStacks;
+    words[4] = (std::uint32_t)stackCapacity;
+    words[5] = (std::uint32_t)base;
+    words[6] = (std::uint32_t)(base >> 32);
+
+    frame.resize(FRAME_HEADER_BYTES);  // buffered records belong to the old contents
+    unsynced = 0;
+    if (!truncateFile(fd, 0) ||
+        !writeAll(fd, reinterpret_cast<const unsigned char*>(words), sizeof(words)) ||
+        !syncFile(fd)) {
+        return false;
+    }
+    baseSequence = base;
+    nextSequence = base;
+    return true;
+}
+
+bool Journal::writeOut(bool durable) {
+    std::lock_guard<std::mutex> fileGuard(fileLock);
+    int pending;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (failed) return false;
+        frame.swap(writing);
+        frame.resize(FRAME_HEADER_BYTES);
+        pending = unsynced;
+        if (durable) unsynced = 0;
+    }
+
+    // Appends carry on into frame meanwhile
+    bool written = true;
+    std::size_t length = writing.size() - FRAME_HEADER_BYTES;
+    if (length > 0) {
+        std::uint32_t header[2] = {(std::uint32_t)length, crc32(writing.data() + FRAME_HEADER_BYTES, length)};
+        std::memcpy(writing.data(), header, sizeof(header));
+        written = writeAll(fd, writing.data(), writing.size());
+    }
+    if (written && durable && pending > 0) written = syncFile(fd);
+    if (!written) {
+        std::lock_guard<std::mutex> guard(lock);
+        failed = true;
+    }
+    return written;
+}
+
+bool Journal::ok() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return !failed;
+}
+
+void Journal::append(const TraceRecord &record) {
+    bool commit, full;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (failed) return;
+        appendTraceRecord(frame, record);
+        ++nextSequence;
+        ++unsynced;
+        commit = config.groupCommitRecords > 0 && unsynced >= config.groupCommitRecords;
+        full = frame.size() - FRAME_HEADER_BYTES >= config.writeBufferBytes;
+    }
+    if (commit || full) writeOut(commit);
+}
+
+bool Journal::sync() {
+    return writeOut(true);
+}
+
+std::uint64_t Journal::sequence() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return nextSequence;
+}
+
+std::uint64_t Journal::getBaseSequence() const {
+    std::lock_guard<std::mutex> guard(lock);
+    return baseSequence;
+}
+
+int Journal::getNumStacks() const {
+    return numStacks;
+}
+
+int Journal::getStackCapacity() const {
+    return stackCapacity;
+}
+
+bool Journal::restart(std::uint64_t base) {
+    std::lock_guard<std::mutex> fileGuard(fileLock);
+    std::lock_guard<std::mutex> guard(lock);
+    if (failed) return false;
+    failed = !writeHeader(base);
+    return !failed;
+}
+
+bool Journal::replay(ParkingLot &lot, std::uint64_t fromSequence) {
+    std::uint64_t sequence;
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (failed || fromSequence < baseSequence) return false;
+        sequence = baseSequence;
+    }
+    if (!writeOut(false)) return false;  // include buffered records
+
+    std::vector<unsigned char> bytes;
+    {
+        std::lock_guard<std::mutex> fileGuard(fileLock);
+        if (!readAll(fd, bytes)) return false;
+    }
+
+    // Applied outside the locks: the lot may be journaling to another journal
+    std::uint64_t records;
+    bool undecodable;
+    scanFrames(bytes, records, undecodable, [&](const TraceRecord &record) {
+        if (sequence++ >= fromSequence) applyTraceRecord(lot, record);
+    });
+    return !undecodable;
+}
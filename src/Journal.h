@@ -0,0 +1,138 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+#include "Trace.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// When buffered journal records are made durable
+struct JournalConfig {
+    // A background thread commits waiting records (write + fsync) this often,
+    // so at most this much work is lost in a crash. 0 = no background commits.
+    int groupCommitMillis = 10;
+
+    // Also commit, on the appending thread, once this many records are
+    // waiting: 1 makes every operation durable before it returns. 0 = off.
+    int groupCommitRecords = 0;
+
+    // Waiting records are handed to the OS once they take this many bytes,
+    // even between commits
+    std::size_t writeBufferBytes = 1 << 16;
+};
+
+// Append-only write-ahead journal of the operations that change a ParkingLot
+// (see ParkingLot::setJournal), so a lot can be rebuilt after a crash from
+// its last snapshot plus the journal (ParkingLot::recover).
+//
+// Records use the trace encoding (see Trace.h). Every record has a sequence
+// number, counted across restarts; a snapshot stores the sequence it covers,
+// so recovery knows where to pick up. Records are buffered in memory and
+// written as frames with a length and CRC-32, so a frame torn by a crash is
+// detected and dropped on reopen together with everything after it. A frame
+// that passes its CRC but holds an op this build does not know came from a
+// newer build; the journal is then refused, never cut.
+//
+// File layout (32-bit words in host byte order, then frames):
+//   "PLJN" version byteOrderMark numStacks stackCapacity baseSeqLow baseSeqHigh
+//   per frame: byteCount crc32 records...
+//
+// Thread-safe: appends, sync() and the sequence accessors may be called from
+// any thread. Appends only encode into memory; writes and fsyncs happen
+// outside the append lock, so appending continues while a commit is running.
+class Journal {
+private:
+    JournalConfig config;
+    int fd;
+    int numStacks;
+    int stackCapacity;
+    std::uint64_t baseSequence;  // sequence of the first record in the file
+    std::uint64_t nextSequence;  // sequence the next appended record gets
+
+    std::vector<unsigned char> frame;    // frame header space + buffered records
+    std::vector<unsigned char> writing;  // frame being written (swapped with frame)
+    int unsynced;                        // records appended since the last commit
+    bool failed;
+    bool stopping;
+
+    // Lock order: fileLock -> lock
+    mutable std::mutex lock;  // guards everything above except writing
+    std::mutex fileLock;      // serializes writes to fd, guards writing
+    std::condition_variable wake;
+    std::thread committer;    // background group commit, if groupCommitMillis > 0
+
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+
+    // Hand the buffered records to the OS as one frame, then fsync if
+    // durable is set and something is waiting. Takes both locks itself.
+    // Time Complexity: O(b) for b buffered bytes, plus the fsync
+    bool writeOut(bool durable);
+
+    // Truncate the file to a fresh header starting at base.
+    // Caller holds both locks.
+    // Time Complexity: O(1) plus the cost of the fsync
+    bool writeHeader(std::uint64_t base);
+
+    // Body of the committer thread.
+    // Time Complexity: runs until the journal is destroyed
+    void commitLoop();
+
+public:
+    // Opens path, creating it for a lot of the given shape if it is missing
+    // or empty. An existing journal must be for the same shape and version;
+    // a torn or corrupt tail is cut off, and appends continue after the last
+    // intact frame.
+    // Time Complexity: O(f) for a file of f bytes
+    Journal(const char* path, int numStacks, int stackCapacity,
+            const JournalConfig &config = JournalConfig());
+
+    // Syncs and closes.
+    // Time Complexity: O(b) plus the cost of the fsync
+    ~Journal();
+
+    // False if the file could not be opened, belongs to another shape or
+    // version, holds records this build cannot decode, or a write or fsync failed. Once false,
+    // appends are dropped.
+    // Time Complexity: O(1)
+    bool ok() const;
+
+    // Buffer one record; commits on this thread if groupCommitRecords are waiting.
+    // Time Complexity: O(1), plus a write and fsync at such commits
+    void append(const TraceRecord &record);
+
+    // Write and fsync everything appended so far.
+    // Time Complexity: O(b) plus the cost of the fsync
+    bool sync();
+
+    // Sequence number the next appended record will get, i.e. the number of
+    // records ever appended to this journal (before and after restarts).
+    // Time Complexity: O(1)
+    std::uint64_t sequence() const;
+
+    // Sequence of the first record kept in the file.
+    // Time Complexity: O(1)
+    std::uint64_t getBaseSequence() const;
+
+    // Time Complexity: O(1)
+    int getNumStacks() const;
+
+    // Time Complexity: O(1)
+    int getStackCapacity() const;
+
+    // Discard every record and continue at base (normally the sequence a
+    // snapshot was just taken at). Durable when it returns true; false if
+    // the journal is not ok().
+    // Time Complexity: O(1) plus the cost of the fsync
+    bool restart(std::uint64_t base);
+
+    // Apply the records numbered fromSequence onwards to lot, in order
+    // (see applyTraceRecord). Returns false if the file cannot be read,
+    // fromSequence lies before the first record kept, or a frame does not decode.
+    // Time Complexity: O(f) plus the replayed operations
+    bool replay(ParkingLot &lot, std::uint64_t fromSequence);
+};
+
+#endif // JOURNAL_H
@@ -0,0 +1,95 @@
+#include "LotEvent.h"
+#include <iostream>
+
+void ConsoleEventSink::onEvent(const LotEvent &e) {
+    if (e.status == LotStatus::InvalidStack) {
+        std::cout << "Invalid stack index.\n";
+        return;
+    }
+    if (e.status == LotStatus::QueueEmpty) {
+        std::cout << "Entrance queue is empty. No car to park.\n";
+        return;
+    }
+
+    switch (e.operation) {
+    case LotOperation::AddCar:
+        if (e.status == LotStatus::DuplicateCar) {
+            std::cout << "Error: A car with ID " << e.carId
+                      << " already exists in the system (queue or stacks).\n";
+        } else {
+            std::cout << "Car " << e.carId << " added to entrance queue.\n";
+        }
+        break;
+
+    case LotOperation::ParkFirst:
+    case LotOperation::ParkSpecific:
+        if (e.status == LotStatus::ParkingFull) {
+            std::cout << "Parking full. Car " << e.carId << " cannot be parked.\n";
+        } else if (e.status == LotStatus::StackFull) {
+            std::cout << "Selected stack is full. Car " << e.carId << " cannot be parked.\n";
+        } else {
+            std::cout << "Car " << e.carId << " parked in stack " << e.stackIndex << ".\n";
+        }
+        break;
+
+    case LotOperation::ExitCar:
+        if (e.status == LotStatus::StackEmpty) {
+            std::cout << "Stack " << e.stackIndex << " is empty.\n";
+        } else if (e.status == LotStatus::NotOnTop) {
+            std::cout << "Cannot remove car " << e.carId
+                      << ". Only the car at the top (car " << e.topCarId
+                      << ") can exit from stack " << e.stackIndex << ".\n";
+        } else {
+            std::cout << "Car " << e.carId << " exited from stack " << e.stackIndex << ".\n";
+        }
+        break;
+
+    case LotOperation::SortStack:
+        std::cout << "Stack " << e.stackIndex << " has been sorted by car ID.\n";
+        break;
+
+    case LotOperation::MoveStacks:
+        if (e.status == LotStatus::SameStack) {
+            std::cout << "Source and target stacks are the same. No movement performed.\n";
+        } else if (e.status == LotStatus::StackEmpty) {
+            std::cout << "Source stack " << e.stackIndex << " is already empty.\n";
+        } else if (e.status == LotStatus::NotEnoughSpace) {
+            std::cout << "Moved " << e.carsMoved << " cars from stack " << e.stackIndex
+                      << " to stack " << e.targetIndex << " onwards.\n"
+                      << "Warning: Not enough space to move all cars from stack "
+                      << e.stackIndex << ". Some cars remain.\n";
+        } else {
+            std::cout << "Moved " << e.carsMoved << " cars from stack " << e.stackIndex
+                      << " to stack " << e.targetIndex << " onwards.\n"
+                      << "All cars moved. Stack " << e.stackIndex << " is now empty.\n";
+        }
+        break;
+
+    case LotOperation::MoveTopCar:
+        if (e.status == LotStatus::SameStack) {
+            std::cout << "Source and target stacks are the same. No movement performed.\n";
+        } else if (e.status == LotStatus::StackEmpty) {
+            std::cout << "Stack " << e.stackIndex << " is empty.\n";
+        } else if (e.status == LotStatus::StackFull) {
+            std::cout << "Stack " << e.targetIndex << " is full. Car " << e.carId << " stays in stack "
+                      << e.stackIndex << ".\n";
+        } else {
+            std::cout << "Moved car " << e.carId
+                      << " from stack " << e.stackIndex
+                      << " to stack " << e.targetIndex << ".\n";
+        }
+        break;
+
+    case LotOperation::RetrieveCar:
+        if (e.status == LotStatus::CarNotFound) {
+            std::cout << "Car " << e.carId << " is not parked in any stack.\n";
+        } else if (e.status == LotStatus::NotEnoughSpace) {
+            std::cout << "Not enough free space in the other stacks to retrieve car "
+                      << e.carId << " from stack " << e.stackIndex << ".\n";
+        } else {
+            std::cout << "Car " << e.carId << " retrieved from stack " << e.stackIndex
+                      << " after relocating " << e.carsMoved << " cars.\n";
+        }
+        break;
+    }
+}
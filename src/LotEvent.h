@@ -0,0 +1,41 @@
+#ifndef LOTEVENT_H
+#define LOTEVENT_H
+#include "LotStatus.h"
+
+// Which ParkingLot operation an event reports
+enum class LotOperation {
+    AddCar,
+    ParkFirst,
+    ParkSpecific,
+    ExitCar,
+    SortStack,
+    MoveStacks,     // moveBetweenStacks finished (or was rejected)
+    MoveTopCar,
+    RetrieveCar
+};
+
+// One reportable outcome. Fields that do not apply to the operation are 0.
+struct LotEvent {
+    LotOperation operation;
+    LotStatus status;
+    int carId;
+    int stackIndex;   // 1-based stack the operation acted on (source for moves)
+    int targetIndex;  // 1-based target stack for moves
+    int topCarId;     // car blocking an exit (NotOnTop)
+    int carsMoved;    // cars moved by moveBetweenStacks or retrieveCar
+};
+
+// Receives ParkingLot events. A lot without a sink does no reporting at all.
+class LotEventSink {
+public:
+    virtual ~LotEventSink() {}
+    virtual void onEvent(const LotEvent &event) = 0;
+};
+
+// Prints each event to std::cout as a one-line status message
+class ConsoleEventSink : public LotEventSink {
+public:
+    void onEvent(const LotEvent &event) override;
+};
+
+#endif // LOTEVENT_H
@@ -0,0 +1,55 @@
+#ifndef LOTSTATUS_H
+#define LOTSTATUS_H
+#include <vector>
+
+// Outcome of a ParkingLot operation
+enum class LotStatus {
+    Ok,
+    DuplicateCar,    // car ID already in the queue or a stack
+    QueueEmpty,      // no car waiting at the entrance
+    ParkingFull,     // no stack has free space (the dequeued car is dropped)
+    InvalidStack,    // stack index out of range
+    StackFull,       // the chosen stack has no free space (the dequeued car is dropped)
+    StackEmpty,      // the chosen stack has no cars
+    NotOnTop,        // the car is not at the top of the stack
+    SameStack,       // source and target stack are the same
+    NotEnoughSpace,  // moveBetweenStacks could not move every car, or
+                     // retrieveCar found no room for the cars above it
+    CarNotFound      // no stack holds the car (unknown, or still in the queue)
+};
+
+// Outcome of parking one car
+struct ParkResult {
+    LotStatus status;
+    int carId;       // car taken from the queue, 0 if none
+    int stackIndex;  // 1-based stack the car was parked in, 0 if not parked
+};
+
+// Outcome of a car lookup
+struct FindResult {
+    bool found;
+    int stackIndex;  // 1-based, 0 if not found
+    int position;    // 1 = top of the stack, 0 if not found
+};
+
+// Outcome of moveBetweenStacks
+struct MoveResult {
+    LotStatus status;
+    int carsMoved;
+};
+
+// One car relocated by retrieveCar
+struct CarMove {
+    int carId;
+    int fromStack;  // 1-based
+    int toStack;    // 1-based
+};
+
+// Outcome of retrieveCar
+struct RetrieveResult {
+    LotStatus status;
+    int stackIndex;              // 1-based stack the car was in, 0 if not found
+    std::vector<CarMove> moves;  // relocations made, in order (empty unless Ok)
+};
+
+#endif // LOTSTATUS_H
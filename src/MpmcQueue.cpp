@@ -0,0 +1,78 @@
+#include "MpmcQueue.h"
+
+MpmcQueue::MpmcQueue(int capacity) : enqueuePos(0), dequeuePos(0) {
+    // Clamp first: a negative capacity cast to size_t would never be reached
+    if (capacity < 1) capacity = 1;
+    if (capacity > MAX_CARS) capacity = MAX_CARS;
+    std::size_t count = 2;
+    while (count < (std::size_t)capacity) count <<= 1;
+    mask = count - 1;
+    slots = new Slot[count];
+    // Slot i is free for the enqueue at position i
+    for (std::size_t i = 0; i < count; ++i) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+MpmcQueue::~MpmcQueue() {
+    delete [] slots;
+}
+
+bool MpmcQueue::enqueue(int carId) {
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = slots[pos & mask];
+        std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)pos;
+        if (diff == 0) {
+            // Slot is free for this position; claim it
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                slot.carId = carId;
+                slot.sequence.store(pos + 1, std::memory_order_release);  // publish
+                return true;
+            }
+            // CAS failure reloaded pos
+        } else if (diff < 0) {
+            return false;  // the slot still holds a car from one lap ago: full
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);  // another gate got here first
+        }
+    }
+}
+
+bool MpmcQueue::dequeue(int &carId) {
+    std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = slots[pos & mask];
+        std::size_t seq = slot.sequence.load(std::memory_order_acquire);
+        std::ptrdiff_t diff = (std::ptrdiff_t)seq - (std::ptrdiff_t)(pos + 1);
+        if (diff == 0) {
+            // Slot holds the car for this position; claim it
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                carId = slot.carId;
+                // Free the slot for the enqueue one lap ahead
+                slot.sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  // not written yet: empty
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+int MpmcQueue::size() const {
+    std::size_t tail = dequeuePos.load(std::memory_order_relaxed);
+    std::size_t head = enqueuePos.load(std::memory_order_relaxed);
+    // The two loads are not atomic together; clamp a transiently negative result
+    return head > tail ? (int)(head - tail) : 0;
+}
+
+bool MpmcQueue::isEmpty() const {
+    return size() == 0;
+}
+
+int MpmcQueue::getCapacity() const {
+    return (int)(mask + 1);
+}
@@ -0,0 +1,62 @@
+#ifndef MPMCQUEUE_H
+#define MPMCQUEUE_H
+#include <atomic>
+#include <cstddef>
+
+// Lock-free entrance queue of car IDs for several gates (producers) and
+// several parking workers (consumers) at once. Bounded ring after Vyukov:
+// every slot carries a sequence number that says whether it is ready to be
+// written or read, so enqueue and dequeue each need a single CAS on their
+// own position counter and never block each other.
+// When the ring is full enqueue() returns false, like a bounded RingQueue.
+// ParkingLot::admitFromQueue drains one into the lot in batches.
+class MpmcQueue {
+private:
+    struct Slot {
+        std::atomic<std::size_t> sequence;
+        int carId;
+    };
+
+    // Keep the two hot counters on separate cache lines
+    static const std::size_t CACHE_LINE = 64;
+
+    Slot* slots;
+    std::size_t mask;  // slot count - 1 (slot count is a power of two)
+    alignas(CACHE_LINE) std::atomic<std::size_t> enqueuePos;
+    alignas(CACHE_LINE) std::atomic<std::size_t> dequeuePos;
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+public:
+    // Largest slot count, same ceiling as RingQueue::MAX_CARS
+    static const int MAX_CARS = 1 << 30;
+
+    // Capacity is rounded up to a power of two (at least 2); a capacity
+    // below 1 is treated as 1 and one above MAX_CARS as MAX_CARS.
+    // Time Complexity: O(capacity)
+    explicit MpmcQueue(int capacity);
+
+    // Time Complexity: O(1)
+    ~MpmcQueue();
+
+    // Returns false (and does nothing) when the queue is full.
+    // Time Complexity: O(1) (lock-free; retries only when another gate wins the slot)
+    bool enqueue(int carId);
+
+    // Returns false when the queue is empty.
+    // Time Complexity: O(1) (lock-free)
+    bool dequeue(int &carId);
+
+    // Snapshot only: other threads may change it right away.
+    // Time Complexity: O(1)
+    int size() const;
+
+    // Time Complexity: O(1)
+    bool isEmpty() const;
+
+    // Time Complexity: O(1)
+    int getCapacity() const;
+};
+
+#endif // MPMCQUEUE_H
@@ -1,175 +1,923 @@
 #include "ParkingLot.h"
+#include "Journal.h"
+#include "MpmcQueue.h"
+#include "RingQueue.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <string>
 
-ParkingLot::ParkingLot(int nStacks, int capacityPerStack)
+namespace {
+
+// Holds the mutex for the guard's lifetime; a null mutex (single-threaded mode) is a no-op
+template <class Mutex>
+class OptionalLock {
+private:
+    Mutex* mutex;
+
+    OptionalLock(const OptionalLock&) = delete;
+    OptionalLock& operator=(const OptionalLock&) = delete;
+
+public:
+    explicit OptionalLock(Mutex* m) : mutex(m) {
+        if (mutex) mutex->lock();
+    }
+    ~OptionalLock() {
+        if (mutex) mutex->unlock();
+    }
+};
+
+// Shared (reader) counterpart of OptionalLock
+class OptionalSharedLock {
+private:
+    std::shared_mutex* mutex;
+
+    OptionalSharedLock(const OptionalSharedLock&) = delete;
+    OptionalSharedLock& operator=(const OptionalSharedLock&) = delete;
+
+public:
+    explicit OptionalSharedLock(std::shared_mutex* m) : mutex(m) {
+        if (mutex) mutex->lock_shared();
+    }
+    ~OptionalSharedLock() {
+        if (mutex) mutex->unlock_shared();
+    }
+};
+
+} // namespace
+
+ParkingLot::ParkingLot(int nStacks, int capacityPerStack, bool concurrentMode)
     : numStacks(nStacks),
-      stackCapacity(capacityPerStack) {
+      stackCapacity(capacityPerStack),
+      freeLanes(nStacks),
+      laneVersions(new std::atomic<std::uint32_t>[nStacks]()),
+      eventSink(nullptr),
+      journal(nullptr),
+      workerPool(nullptr),
+      concurrent(concurrentMode),
+      laneLocks(concurrentMode ? new std::mutex[nStacks] : nullptr) {
     stacks = new Stack[numStacks];
     for (int i = 0; i < numStacks; ++i) {
         stacks[i] = Stack(stackCapacity);
+        laneChanged(i);
     }
 }
 
 ParkingLot::~ParkingLot() {
+    delete workerPool;
+    delete [] laneLocks;
+    delete [] laneVersions;
     delete [] stacks;
 }
 
+void ParkingLot::setEventSink(LotEventSink* sink) {
+    eventSink = sink;
+}
+
+void ParkingLot::setJournal(Journal* writer) {
+    journal = writer;
+}
+
 bool ParkingLot::isValidStackIndex(int stackIndex) const {
     return stackIndex >= 1 && stackIndex <= numStacks;
 }
 
-void ParkingLot::addCarToEntrance(int carId) {
-    if (carAlreadyInSystem(carId)) {
-        std::cout << "Error: A car with ID " << carId
-                  << " already exists in the system (queue or stacks).\n";
-        return;
+LotStatus ParkingLot::addCarToEntrance(int carId) {
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+
+    // Every car in the queue or a stack has an index entry — used to prevent duplicate car IDs
+    bool added;
+    {
+        OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+        added = carIndex.insert(carId, CarLocation{-1, 0});
+    }
+    if (!added) {
+        notify(LotOperation::AddCar, LotStatus::DuplicateCar, carId);
+        return LotStatus::DuplicateCar;
+    }
+    {
+        OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+        entranceQueue.enqueue(carId);
     }
-    entranceQueue.enqueue(carId);
-    std::cout << "Car " << carId << " added to entrance queue.\n";
+    if (journal) journal->append(TraceRecord{TraceOp::Arrive, carId, 0, 0});
+    notify(LotOperation::AddCar, LotStatus::Ok, carId);
+    return LotStatus::Ok;
 }
 
-void ParkingLot::parkCarInFirstAvailableStack() {
-    if (entranceQueue.isEmpty()) {
-        std::cout << "Entrance queue is empty. No car to park.\n";
-        return;
+std::vector<LotStatus> ParkingLot::addCarsToEntrance(const int* carIds, int count) {
+    std::vector<LotStatus> results;
+    if (count <= 0) return results;
+    results.reserve(count);
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    {
+        OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+        carIndex.reserve(carIndex.size() + count);  // one rehash for the whole burst
+
+        for (int i = 0; i < count; ++i) {
+            // insert fails for IDs already indexed, including earlier ones in this batch
+            bool added = carIndex.insert(carIds[i], CarLocation{-1, 0});
+            results.push_back(added ? LotStatus::Ok : LotStatus::DuplicateCar);
+        }
+    }
+    {
+        OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+        for (int i = 0; i < count; ++i) {
+            if (results[i] == LotStatus::Ok) entranceQueue.enqueue(carIds[i]);
+        }
+    }
+    if (journal) {
+        for (int i = 0; i < count; ++i) {
+            if (results[i] == LotStatus::Ok) journal->append(TraceRecord{TraceOp::Arrive, carIds[i], 0, 0});
+        }
     }
+    return results;
+}
+
+int ParkingLot::admitFromGate(RingQueue &gate, int maxCars) {
+    int count = maxCars < gate.size() ? maxCars : gate.size();
+    if (count <= 0) return 0;
+    std::vector<int> carIds(count);
+    count = gate.dequeueBatch(carIds.data(), count);
+    std::vector<LotStatus> results = addCarsToEntrance(carIds.data(), count);
+    return (int)std::count(results.begin(), results.end(), LotStatus::Ok);
+}
+
+int ParkingLot::admitFromQueue(MpmcQueue &queue, int maxCars) {
+    if (maxCars <= 0) return 0;
+    // Other workers may take cars first, so size() is only a hint
+    std::vector<int> carIds;
+    carIds.reserve(maxCars < queue.size() ? maxCars : queue.size());
     int carId;
-    entranceQueue.dequeue(carId);
+    while ((int)carIds.size() < maxCars && queue.dequeue(carId)) carIds.push_back(carId);
+    if (carIds.empty()) return 0;
+    std::vector<LotStatus> results = addCarsToEntrance(carIds.data(), (int)carIds.size());
+    return (int)std::count(results.begin(), results.end(), LotStatus::Ok);
+}
 
-    for (int i = 0; i < numStacks; ++i) {
-        if (!stacks[i].isFull()) {
-            stacks[i].push(carId);
-            std::cout << "Car " << carId << " parked in stack " << (i + 1) << ".\n";
-            return;
+ParkResult ParkingLot::parkCarInFirstAvailableStack() {
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    ParkResult result;
+    {
+        OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+        if (entranceQueue.isEmpty()) {
+            result = ParkResult{LotStatus::QueueEmpty, 0, 0};
+        } else {
+            result = parkInFirstFreeLane(entranceQueue.detachFront());
         }
     }
+    // A dropped car (ParkingFull) changes the lot too
+    if (journal && result.status != LotStatus::QueueEmpty) {
+        journal->append(TraceRecord{TraceOp::ParkFirst, 0, 0, 0});
+    }
+    notify(LotOperation::ParkFirst, result.status, result.carId, result.stackIndex);
+    return result;
+}
+
+ParkResult ParkingLot::parkInFirstFreeLane(Car* car) {
+    int carId = car->carId;
+
+    // In concurrent mode a lane can fill up between the freeLanes lookup and
+    // taking its lock; its bit is then refreshed and the search repeated.
+    for (;;) {
+        int lane;
+        {
+            OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+            lane = freeLanes.findFirst();
+        }
+        if (lane == -1) break;
+
+        OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+        if (stacks[lane].pushNode(car)) {  // relink, no reallocation
+            {
+                OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                indexPush(lane, carId);
+            }
+            laneChanged(lane);
+            return ParkResult{LotStatus::Ok, carId, lane + 1};
+        }
+        laneChanged(lane);
+    }
 
     // All stacks full — car is lost (dequeued but not parked)
-    std::cout << "Parking full. Car " << carId << " cannot be parked.\n";
+    {
+        OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+        carIndex.erase(carId);
+    }
+    delete car;
+    return ParkResult{LotStatus::ParkingFull, carId, 0};
 }
 
-void ParkingLot::parkCarInSpecificStack(int stackIndex) {
-    if (!isValidStackIndex(stackIndex)) {
-        std::cout << "Invalid stack index.\n";
-        return;
+std::vector<ParkResult> ParkingLot::parkBatch(int maxCars) {
+    std::vector<ParkResult> results;
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+
+    int toPark = maxCars < entranceQueue.size() ? maxCars : entranceQueue.size();
+    if (toPark <= 0) return results;
+    results.reserve(toPark);
+
+    // Lanes before the current one are full, so one forward sweep suffices
+    int lane;
+    {
+        OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+        lane = freeLanes.findFirst();
+    }
+    while (toPark > 0 && lane != -1) {
+        {
+            OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+            Stack &target = stacks[lane];
+            {
+                OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                while (toPark > 0 && !target.isFull()) {
+                    Car* car = entranceQueue.detachFront();
+                    int carId = car->carId;
+                    target.pushNode(car);
+                    indexPush(lane, carId);
+                    results.push_back(ParkResult{LotStatus::Ok, carId, lane + 1});
+                    --toPark;
+                }
+            }
+            laneChanged(lane);
+        }
+        OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+        lane = freeLanes.findNext(lane + 1);
     }
-    if (entranceQueue.isEmpty()) {
-        std::cout << "Entrance queue is empty. No car to park.\n";
-        return;
+    if (journal) {
+        // Same lane choice as parking the cars one by one
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            journal->append(TraceRecord{TraceOp::ParkFirst, 0, 0, 0});
+        }
     }
+    return results;
+}
 
-    int carId;
-    entranceQueue.dequeue(carId);
-
-    Stack &target = stacks[stackIndex - 1];
-    if (target.isFull()) {
-        std::cout << "Selected stack is full. Car " << carId << " cannot be parked.\n";
-        return;
+ParkResult ParkingLot::parkCarInSpecificStack(int stackIndex) {
+    if (!isValidStackIndex(stackIndex)) {
+        notify(LotOperation::ParkSpecific, LotStatus::InvalidStack, 0, stackIndex);
+        return ParkResult{LotStatus::InvalidStack, 0, 0};
     }
 
-    target.push(carId);
-    std::cout << "Car " << carId << " parked in stack " << stackIndex << ".\n";
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    ParkResult result;
+    {
+        OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+        if (entranceQueue.isEmpty()) {
+            result = ParkResult{LotStatus::QueueEmpty, 0, 0};
+        } else {
+            Car* car = entranceQueue.detachFront();
+            int carId = car->carId;
+            int lane = stackIndex - 1;
+
+            OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+            bool parked = stacks[lane].pushNode(car);
+            {
+                OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                if (parked) {
+                    indexPush(lane, carId);
+                } else {
+                    carIndex.erase(carId);  // selected stack full — car is lost
+                }
+            }
+            if (parked) {
+                laneChanged(lane);
+                result = ParkResult{LotStatus::Ok, carId, stackIndex};
+            } else {
+                delete car;
+                result = ParkResult{LotStatus::StackFull, carId, 0};
+            }
+        }
+    }
+    if (journal && result.status != LotStatus::QueueEmpty) {
+        journal->append(TraceRecord{TraceOp::ParkSpecific, 0, stackIndex, 0});
+    }
+    notify(LotOperation::ParkSpecific, result.status, result.carId, stackIndex);
+    return result;
 }
 
 bool ParkingLot::findCar(int carId, int &stackIndex, int &position) const {
-    for (int i = 0; i < numStacks; ++i) {
-        int pos = stacks[i].findPosition(carId);
-        if (pos != -1) {
-            stackIndex = i + 1;
-            position = pos;
-            return true;
+    if (!concurrent) {
+        const CarLocation* loc = carIndex.find(carId);
+        if (loc == nullptr || loc->lane < 0) {
+            return false;  // unknown, or still waiting in the entrance queue
         }
+        stackIndex = loc->lane + 1;
+        position = stacks[loc->lane].size() - loc->slot;  // 1 = top
+        return true;
+    }
+
+    // Concurrent: an entry only changes lane while that lane is locked, so
+    // look the lane up, lock it, and confirm the car is still there.
+    for (;;) {
+        int lane;
+        {
+            std::shared_lock<std::shared_mutex> indexGuard(indexLock);
+            const CarLocation* loc = carIndex.find(carId);
+            if (loc == nullptr || loc->lane < 0) return false;
+            lane = loc->lane;
+        }
+        std::lock_guard<std::mutex> laneGuard(laneLocks[lane]);
+        std::shared_lock<std::shared_mutex> indexGuard(indexLock);
+        const CarLocation* loc = carIndex.find(carId);
+        if (loc == nullptr || loc->lane < 0) return false;
+        if (loc->lane != lane) continue;  // moved meanwhile; retry
+        stackIndex = lane + 1;
+        position = stacks[lane].size() - loc->slot;
+        return true;
     }
-    return false;
 }
 
-bool ParkingLot::exitCarFromStackTop(int carId, int stackIndex) {
+bool ParkingLot::findCarByScan(int carId, int &stackIndex, int &position, int threads) const {
+    int foundLane = -1;
+
+    if (threads == 1 || numStacks < 2) {
+        for (int i = 0; i < numStacks && foundLane == -1; ++i) {
+            OptionalLock<std::mutex> laneGuard(laneMutex(i));
+            if (stacks[i].findPosition(carId) != -1) foundLane = i;
+        }
+    } else {
+        // Lowest lane known to hold the car; numStacks = not found yet.
+        // The serial scan answers with the lowest lane, so only lanes below
+        // the current best are still worth scanning.
+        std::atomic<int> best(numStacks);
+        ThreadPool &workers = pool(threads);
+        int grain = numStacks / (workers.size() * 16);
+        workers.parallelFor(0, numStacks, grain, [&](int lo, int hi) {
+            for (int lane = lo; lane < hi; ++lane) {
+                if (lane >= best.load(std::memory_order_relaxed)) return;
+                OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+                if (stacks[lane].findPosition(carId) != -1) {
+                    int current = best.load();
+                    while (lane < current && !best.compare_exchange_weak(current, lane)) {
+                    }
+                    return;
+                }
+            }
+        });
+        if (best.load() < numStacks) foundLane = best.load();
+    }
+
+    if (foundLane == -1) return false;
+    OptionalLock<std::mutex> laneGuard(laneMutex(foundLane));
+    int pos = stacks[foundLane].findPosition(carId);
+    if (pos == -1) return false;  // concurrent mode: left the lane after the scan
+    stackIndex = foundLane + 1;
+    position = pos;
+    return true;
+}
+
+LotStatus ParkingLot::exitCarFromStackTop(int carId, int stackIndex) {
     if (!isValidStackIndex(stackIndex)) {
-        std::cout << "Invalid stack index.\n";
-        return false;
+        notify(LotOperation::ExitCar, LotStatus::InvalidStack, carId, stackIndex);
+        return LotStatus::InvalidStack;
     }
 
-    Stack &s = stacks[stackIndex - 1];
-    if (s.isEmpty()) {
-        std::cout << "Stack " << stackIndex << " is empty.\n";
-        return false;
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    LotStatus status;
+    int topId = 0;
+    {
+        int lane = stackIndex - 1;
+        OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+        Stack &s = stacks[lane];
+        if (s.isEmpty()) {
+            status = LotStatus::StackEmpty;
+        } else {
+            s.peek(topId);
+            if (topId != carId) {
+                status = LotStatus::NotOnTop;
+            } else {
+                int removedId;
+                s.pop(removedId);
+                {
+                    OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                    carIndex.erase(removedId);
+                }
+                laneChanged(lane);
+                status = LotStatus::Ok;
+            }
+        }
+    }
+    if (journal && status == LotStatus::Ok) {
+        journal->append(TraceRecord{TraceOp::Exit, carId, stackIndex, 0});
     }
+    notify(LotOperation::ExitCar, status, carId, stackIndex, 0,
+           status == LotStatus::NotOnTop ? topId : 0);
+    return status;
+}
 
-    int topId;
-    s.peek(topId);
-    if (topId != carId) {
-        std::cout << "Cannot remove car " << carId
-                  << ". Only the car at the top (car " << topId
-                  << ") can exit from stack " << stackIndex << ".\n";
-        return false;
+RetrieveResult ParkingLot::retrieveCar(int carId) {
+    RetrieveResult result{LotStatus::CarNotFound, 0, {}};
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+
+    // Plan against the first `wanted` non-full lanes. In concurrent mode they
+    // are locked together with the car's lane (ascending), and the plan is
+    // redone with more lanes if they lack room or the car moved meanwhile.
+    std::vector<int> targets;  // ascending
+    std::vector<int> locked;   // targets plus the car's lane, ascending
+    std::size_t wanted = 1;
+    for (;;) {
+        int lane;
+        {
+            OptionalSharedLock indexGuard(whenConcurrent(indexLock));
+            const CarLocation* loc = carIndex.find(carId);
+            if (loc == nullptr || loc->lane < 0) break;  // CarNotFound
+            lane = loc->lane;
+        }
+
+        targets.clear();
+        {
+            OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+            for (int t = freeLanes.findFirst(); t != -1 && targets.size() < wanted;
+                 t = freeLanes.findNext(t + 1)) {
+                if (t != lane) targets.push_back(t);
+            }
+        }
+        bool everyFreeLane = targets.size() < wanted;
+
+        if (concurrent) {
+            locked = targets;
+            locked.insert(std::upper_bound(locked.begin(), locked.end(), lane), lane);
+            for (int l : locked) laneLocks[l].lock();
+        }
+
+        int blockers = -1;  // -1: the car left lane before it was locked
+        {
+            OptionalSharedLock indexGuard(whenConcurrent(indexLock));
+            const CarLocation* loc = carIndex.find(carId);
+            if (loc != nullptr && loc->lane == lane) blockers = stacks[lane].size() - 1 - loc->slot;
+        }
+        long long room = 0;
+        for (int t : targets) room += stacks[t].getCapacity() - stacks[t].size();
+
+        bool settled = blockers >= 0 && (room >= blockers || everyFreeLane);
+        if (settled) {
+            result.stackIndex = lane + 1;
+            result.status = room >= blockers ? LotStatus::Ok : LotStatus::NotEnoughSpace;
+        }
+        if (settled && result.status == LotStatus::Ok) {
+            // Each target takes as many blockers as it has room for
+            Stack &source = stacks[lane];
+            std::vector<std::pair<int, int>> runs;  // (target lane, cars moved)
+            result.moves.reserve(blockers);
+            int remaining = blockers;
+            for (std::size_t i = 0; i < targets.size() && remaining > 0; ++i) {
+                Stack &target = stacks[targets[i]];
+                int count = std::min(remaining, target.getCapacity() - target.size());
+                if (count <= 0) continue;
+                const Car* car = source.topCar();
+                for (int k = 0; k < count; ++k, car = car->next) {
+                    result.moves.push_back(CarMove{car->carId, lane + 1, targets[i] + 1});
+                }
+                source.transferTopTo(target, count);
+                runs.push_back(std::make_pair(targets[i], count));
+                remaining -= count;
+            }
+
+            int removedId;
+            source.pop(removedId);
+            {
+                OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                for (const std::pair<int, int> &run : runs) indexRun(run.first, run.second);
+                carIndex.erase(removedId);
+            }
+            for (const std::pair<int, int> &run : runs) laneChanged(run.first);
+            laneChanged(lane);
+        }
+
+        if (concurrent) {
+            for (std::size_t i = locked.size(); i-- > 0; ) laneLocks[locked[i]].unlock();
+        }
+        if (settled) break;
+        if (blockers >= 0) {
+            // Every non-full lane has room for at least one car, so `blockers`
+            // lanes always suffice; at least the lanes that full ones would need
+            int perLane = std::max(stackCapacity, 1);
+            std::size_t atLeast = (std::size_t)((blockers + perLane - 1) / perLane);
+            wanted = std::min(std::max(wanted * 2, atLeast), (std::size_t)blockers);
+        }
     }
 
-    int removedId;
-    s.pop(removedId);
-    std::cout << "Car " << removedId << " exited from stack " << stackIndex << ".\n";
-    return true;
+    if (journal && result.status == LotStatus::Ok) {
+        journal->append(TraceRecord{TraceOp::Retrieve, carId, 0, 0});
+    }
+    notify(LotOperation::RetrieveCar, result.status, carId, result.stackIndex, 0, 0,
+           (int)result.moves.size());
+    return result;
 }
 
-void ParkingLot::sortStack(int stackIndex) {
+LotStatus ParkingLot::sortStack(int stackIndex) {
     if (!isValidStackIndex(stackIndex)) {
-        std::cout << "Invalid stack index.\n";
-        return;
+        notify(LotOperation::SortStack, LotStatus::InvalidStack, 0, stackIndex);
+        return LotStatus::InvalidStack;
+    }
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    {
+        int lane = stackIndex - 1;
+        OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+        stacks[lane].sort();  // Merge or radix sort (ascending)
+        touchLane(lane);
+        OptionalSharedLock indexGuard(whenConcurrent(indexLock));
+        indexLane(lane);
+    }
+    if (journal) journal->append(TraceRecord{TraceOp::Sort, 0, stackIndex, 0});
+    notify(LotOperation::SortStack, LotStatus::Ok, 0, stackIndex);
+    return LotStatus::Ok;
+}
+
+LotStatus ParkingLot::sortStacks(int firstIndex, int lastIndex, int threads) {
+    if (!isValidStackIndex(firstIndex) || !isValidStackIndex(lastIndex) || firstIndex > lastIndex) {
+        notify(LotOperation::SortStack, LotStatus::InvalidStack, 0, firstIndex);
+        return LotStatus::InvalidStack;
+    }
+
+    int first = firstIndex - 1;
+    int end = lastIndex;
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+
+    // Each lane is locked only while it is sorted. The calling thread holds no
+    // lane lock while it waits: it may run other pool tasks that need lane locks
+    // (pool tasks never take journalLock).
+    auto sortLanes = [this](int lo, int hi) {
+        for (int lane = lo; lane < hi; ++lane) {
+            OptionalLock<std::mutex> laneGuard(laneMutex(lane));
+            stacks[lane].sort();
+            touchLane(lane);
+            OptionalSharedLock indexGuard(whenConcurrent(indexLock));
+            indexLane(lane);
+        }
+    };
+    if (threads == 1 || end - first == 1) {
+        sortLanes(first, end);
+    } else {
+        // Lanes are independent; a few chunks per worker keeps them all busy
+        // even when lane sizes differ
+        ThreadPool &workers = pool(threads);
+        int grain = (end - first) / (workers.size() * 8);
+        workers.parallelFor(first, end, grain, sortLanes);
+    }
+
+    if (journal) {
+        for (int lane = first; lane < end; ++lane) journal->append(TraceRecord{TraceOp::Sort, 0, lane + 1, 0});
     }
-    stacks[stackIndex - 1].sort();  // Uses merge sort (ascending)
-    std::cout << "Stack " << stackIndex << " has been sorted by car ID.\n";
+
+    // Sinks are not required to be thread-safe, so report from this thread
+    for (int lane = first; lane < end; ++lane) {
+        notify(LotOperation::SortStack, LotStatus::Ok, 0, lane + 1);
+    }
+    return LotStatus::Ok;
+}
+
+LotStatus ParkingLot::sortAllStacks(int threads) {
+    return sortStacks(1, numStacks, threads);
 }
 
-void ParkingLot::moveBetweenStacks(int sourceIndex, int targetIndex) {
+MoveResult ParkingLot::moveBetweenStacks(int sourceIndex, int targetIndex) {
     if (!isValidStackIndex(sourceIndex) || !isValidStackIndex(targetIndex)) {
-        std::cout << "Invalid stack index.\n";
-        return;
+        notify(LotOperation::MoveStacks, LotStatus::InvalidStack, 0, sourceIndex, targetIndex);
+        return MoveResult{LotStatus::InvalidStack, 0};
     }
     if (sourceIndex == targetIndex) {
-        std::cout << "Source and target stacks are the same. No movement performed.\n";
-        return;
+        notify(LotOperation::MoveStacks, LotStatus::SameStack, 0, sourceIndex, targetIndex);
+        return MoveResult{LotStatus::SameStack, 0};
     }
 
-    Stack &source = stacks[sourceIndex - 1];
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    int sourceLane = sourceIndex - 1;
+    Stack &source = stacks[sourceLane];
+    bool sourceEmpty;
+    {
+        OptionalLock<std::mutex> sourceGuard(laneMutex(sourceLane));
+        sourceEmpty = source.isEmpty();
+    }
+    if (sourceEmpty) {
+        notify(LotOperation::MoveStacks, LotStatus::StackEmpty, 0, sourceIndex, targetIndex);
+        return MoveResult{LotStatus::StackEmpty, 0};
+    }
 
-    if (source.isEmpty()) {
-        std::cout << "Source stack " << sourceIndex << " is already empty.\n";
-        return;
+    int moved = 0;
+    int currentTarget;
+    {
+        OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+        currentTarget = freeLanes.findNext(targetIndex - 1);
     }
 
-    int currentTarget = targetIndex - 1;
+    // Move as many cars as possible, spilling to next non-full stacks if needed
+    while (!sourceEmpty && currentTarget != -1) {
+        if (currentTarget != sourceLane) {
+            // Lock the pair in ascending order
+            int low = sourceLane < currentTarget ? sourceLane : currentTarget;
+            int high = sourceLane < currentTarget ? currentTarget : sourceLane;
+            OptionalLock<std::mutex> lowGuard(laneMutex(low));
+            OptionalLock<std::mutex> highGuard(laneMutex(high));
+            Stack &target = stacks[currentTarget];
+            int count = source.transferTopTo(target, source.size());
+            {
+                OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                indexRun(currentTarget, count);
+            }
+            moved += count;
+            laneChanged(currentTarget);
+            laneChanged(sourceLane);
+            sourceEmpty = source.isEmpty();
+        }
+
+        OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+        currentTarget = freeLanes.findNext(currentTarget + 1);
+    }
 
-    // Move as many cars as possible, spilling to next stacks if needed
-    while (!source.isEmpty() && currentTarget < numStacks) {
-        Stack &target = stacks[currentTarget];
+    if (journal && moved > 0) journal->append(TraceRecord{TraceOp::Move, 0, sourceIndex, targetIndex});
+    LotStatus status = sourceEmpty ? LotStatus::Ok : LotStatus::NotEnoughSpace;
+    notify(LotOperation::MoveStacks, status, 0, sourceIndex, targetIndex, 0, moved);
+    return MoveResult{status, moved};
+}
 
-        while (!source.isEmpty() && !target.isFull()) {
-            int carId;
-            source.pop(carId);
-            target.push(carId);
-            std::cout << "Moved car " << carId
-                      << " from stack " << sourceIndex
-                      << " to stack " << (currentTarget + 1) << ".\n";
+LotStatus ParkingLot::moveTopCar(int sourceIndex, int targetIndex) {
+    if (!isValidStackIndex(sourceIndex) || !isValidStackIndex(targetIndex)) {
+        notify(LotOperation::MoveTopCar, LotStatus::InvalidStack, 0, sourceIndex, targetIndex);
+        return LotStatus::InvalidStack;
+    }
+    if (sourceIndex == targetIndex) {
+        notify(LotOperation::MoveTopCar, LotStatus::SameStack, 0, sourceIndex, targetIndex);
+        return LotStatus::SameStack;
+    }
+
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    int sourceLane = sourceIndex - 1;
+    int targetLane = targetIndex - 1;
+    LotStatus status;
+    int carId = 0;
+    {
+        // Lock the pair in ascending order
+        int low = sourceLane < targetLane ? sourceLane : targetLane;
+        int high = sourceLane < targetLane ? targetLane : sourceLane;
+        OptionalLock<std::mutex> lowGuard(laneMutex(low));
+        OptionalLock<std::mutex> highGuard(laneMutex(high));
+        Stack &source = stacks[sourceLane];
+        Stack &target = stacks[targetLane];
+        if (source.isEmpty()) {
+            status = LotStatus::StackEmpty;
+        } else if (target.isFull()) {
+            source.peek(carId);
+            status = LotStatus::StackFull;
+        } else {
+            Car* car = source.popNode();
+            carId = car->carId;
+            target.pushNode(car);
+            {
+                OptionalLock<std::shared_mutex> indexGuard(whenConcurrent(indexLock));
+                indexPush(targetLane, carId);
+            }
+            laneChanged(targetLane);
+            laneChanged(sourceLane);
+            status = LotStatus::Ok;
         }
+    }
+    if (journal && status == LotStatus::Ok) {
+        journal->append(TraceRecord{TraceOp::MoveTop, 0, sourceIndex, targetIndex});
+    }
+    notify(LotOperation::MoveTopCar, status, carId, sourceIndex, targetIndex);
+    return status;
+}
+
+// ------------------ Snapshots ------------------
+//
+// A snapshot is a sequence of 32-bit words in host byte order, so lanes can
+// be read back in bulk without per-field decoding:
+//   "PLSN" version byteOrderMark numStacks stackCapacity
+//   journalSequenceLow journalSequenceHigh    (version 2 on)
+//   queueCount queuedCarIds...                (front first)
+//   per stack: capacity count carIds...       (top first)
+
+namespace {
+
+const char SNAPSHOT_MAGIC[4] = {'P', 'L', 'S', 'N'};
+const std::int32_t SNAPSHOT_VERSION = 2;
+const std::int32_t BYTE_ORDER_MARK = 0x01020304;  // reads differently on a foreign-endian host
+const int SNAPSHOT_HEADER_WORDS = 7;
+const int SNAPSHOT_V1_HEADER_WORDS = 5;           // version 1 had no journal sequence
+
+} // namespace
 
-        ++currentTarget;
+bool ParkingLot::saveSnapshot(const char* path) const {
+    // Hold back journaled operations so the sequence matches the state
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+    return writeSnapshot(path, journal ? journal->sequence() : 0);
+}
+
+bool ParkingLot::writeSnapshot(const char* path, std::uint64_t sequence) const {
+    // Concurrent mode: hold the queue and every stack so the snapshot is consistent
+    OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+    if (concurrent) {
+        for (int lane = 0; lane < numStacks; ++lane) laneLocks[lane].lock();
     }
 
-    if (!source.isEmpty()) {
-        std::cout << "Warning: Not enough space to move all cars from stack "
-                  << sourceIndex << ". Some cars remain.\n";
+    std::vector<std::int32_t> words;
+    std::size_t cars = (std::size_t)entranceQueue.size();
+    for (int lane = 0; lane < numStacks; ++lane) cars += (std::size_t)stacks[lane].size();
+    words.reserve(SNAPSHOT_HEADER_WORDS + 1 + 2 * (std::size_t)numStacks + cars);
+
+    std::int32_t magic;
+    std::memcpy(&magic, SNAPSHOT_MAGIC, sizeof(magic));
+    words.push_back(magic);
+    words.push_back(SNAPSHOT_VERSION);
+    words.push_back(BYTE_ORDER_MARK);
+    words.push_back(numStacks);
+    words.push_back(stackCapacity);
+    words.push_back((std::int32_t)(std::uint32_t)sequence);
+    words.push_back((std::int32_t)(std::uint32_t)(sequence >> 32));
+
+    words.push_back(entranceQueue.size());
+    for (const Car* c = entranceQueue.frontCar(); c != nullptr; c = c->next) words.push_back(c->carId);
+    for (int lane = 0; lane < numStacks; ++lane) {
+        const Stack &s = stacks[lane];
+        words.push_back(s.getCapacity());
+        words.push_back(s.size());
+        for (const Car* c = s.topCar(); c != nullptr; c = c->next) words.push_back(c->carId);
+    }
+
+    if (concurrent) {
+        for (int lane = numStacks - 1; lane >= 0; --lane) laneLocks[lane].unlock();
+    }
+
+    std::string temporary = std::string(path) + ".tmp";
+    std::FILE* file = std::fopen(temporary.c_str(), "wb");
+    if (file == nullptr) return false;
+    bool written = std::fwrite(words.data(), sizeof(std::int32_t), words.size(), file) == words.size();
+    written = std::fclose(file) == 0 && written;
+    if (written && std::rename(temporary.c_str(), path) != 0) {
+        // Some platforms refuse to rename over an existing file
+        std::remove(path);
+        written = std::rename(temporary.c_str(), path) == 0;
+    }
+    if (!written) std::remove(temporary.c_str());
+    return written;
+}
+
+bool ParkingLot::loadSnapshot(const char* path) {
+    std::uint64_t sequence;
+    return readSnapshot(path, sequence);
+}
+
+bool ParkingLot::readSnapshot(const char* path, std::uint64_t &sequence) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) return false;
+    std::vector<std::int32_t> words;
+    long bytes = -1;
+    if (std::fseek(file, 0, SEEK_END) == 0) bytes = std::ftell(file);
+    if (bytes > 0 && bytes % (long)sizeof(std::int32_t) == 0 && std::fseek(file, 0, SEEK_SET) == 0) {
+        words.resize((std::size_t)bytes / sizeof(std::int32_t));
+        if (std::fread(words.data(), sizeof(std::int32_t), words.size(), file) != words.size()) words.clear();
+    }
+    std::fclose(file);
+
+    // ** Validate everything before touching the lot **
+    std::size_t total = words.size();
+    if (total < SNAPSHOT_V1_HEADER_WORDS + 1) return false;
+    if (std::memcmp(&words[0], SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        words[2] != BYTE_ORDER_MARK) {
+        return false;
+    }
+    std::size_t headerWords;
+    if (words[1] == SNAPSHOT_VERSION) {
+        headerWords = SNAPSHOT_HEADER_WORDS;
+    } else if (words[1] == 1) {
+        headerWords = SNAPSHOT_V1_HEADER_WORDS;
     } else {
-        std::cout << "All cars moved. Stack " << sourceIndex << " is now empty.\n";
+        return false;
+    }
+    if (total < headerWords + 1) return false;
+    int newNumStacks = words[3];
+    int newCapacity = words[4];
+    if (newNumStacks <= 0 || newCapacity < 0) return false;
+    std::uint64_t newSequence = 0;
+    if (headerWords == SNAPSHOT_HEADER_WORDS) {
+        newSequence = (std::uint64_t)(std::uint32_t)words[5] | ((std::uint64_t)(std::uint32_t)words[6] << 32);
     }
+
+    std::size_t at = headerWords;
+    std::int32_t queued = words[at++];
+    if (queued < 0 || (std::size_t)queued > total - at) return false;
+    std::size_t queueStart = at;
+    at += (std::size_t)queued;
+    // Every lane needs at least its capacity and count words; check before
+    // sizing anything from the header
+    if ((std::size_t)newNumStacks > (total - at) / 2) return false;
+
+    std::vector<std::size_t> laneStart(newNumStacks);  // index of each lane's capacity word
+    std::size_t parked = 0;
+    for (int lane = 0; lane < newNumStacks; ++lane) {
+        if (total - at < 2) return false;
+        std::int32_t capacity = words[at];
+        std::int32_t count = words[at + 1];
+        if (capacity < 0 || count < 0 || count > capacity || (std::size_t)count > total - at - 2) return false;
+        laneStart[lane] = at;
+        at += 2 + (std::size_t)count;
+        parked += (std::size_t)count;
+    }
+    if (at != total) return false;
+
+    // The new index doubles as the duplicate check
+    CarIndex newIndex;
+    newIndex.reserve((std::size_t)queued + parked);
+    for (std::int32_t i = 0; i < queued; ++i) {
+        if (!newIndex.insert(words[queueStart + i], CarLocation{-1, 0})) return false;
+    }
+    for (int lane = 0; lane < newNumStacks; ++lane) {
+        std::int32_t count = words[laneStart[lane] + 1];
+        const std::int32_t* ids = &words[laneStart[lane] + 2];
+        for (std::int32_t i = 0; i < count; ++i) {
+            // Slot counts from the bottom; ids are listed top first
+            if (!newIndex.insert(ids[i], CarLocation{lane, count - 1 - i})) return false;
+        }
+    }
+
+    // ** Build the new state directly, then swap it in **
+    Stack* newStacks = new Stack[newNumStacks];
+    for (int lane = 0; lane < newNumStacks; ++lane) {
+        newStacks[lane] = Stack(words[laneStart[lane]]);
+        newStacks[lane].assign(&words[laneStart[lane] + 2], words[laneStart[lane] + 1]);
+    }
+
+    delete [] stacks;
+    stacks = newStacks;
+    if (newNumStacks != numStacks) {
+        delete [] laneVersions;
+        laneVersions = new std::atomic<std::uint32_t>[newNumStacks]();
+        if (concurrent) {
+            delete [] laneLocks;
+            laneLocks = new std::mutex[newNumStacks];
+        }
+    }
+    numStacks = newNumStacks;
+    stackCapacity = newCapacity;
+    carIndex.swap(newIndex);
+
+    entranceQueue.clear();
+    for (std::int32_t i = 0; i < queued; ++i) entranceQueue.enqueue(words[queueStart + i]);
+
+    freeLanes.reset(numStacks);
+    for (int lane = 0; lane < numStacks; ++lane) laneChanged(lane);
+    sequence = newSequence;
+    return true;
+}
+
+// ------------------ Journal ------------------
+
+bool ParkingLot::checkpoint(const char* snapshotPath) {
+    if (journal == nullptr) return false;
+    OptionalLock<std::mutex> orderGuard(whenJournaled());
+
+    // Sync first: after a crash the journal must reach at least as far as the
+    // snapshot, or operations after it would be numbered from too low
+    std::uint64_t sequence = journal->sequence();
+    if (!journal->sync() || !writeSnapshot(snapshotPath, sequence)) return false;
+    return journal->restart(sequence);
+}
+
+bool ParkingLot::recover(const char* snapshotPath, Journal &writer) {
+    if (!writer.ok()) return false;
+
+    std::uint64_t sequence = 0;
+    std::FILE* snapshot = std::fopen(snapshotPath, "rb");
+    if (snapshot != nullptr) {
+        std::fclose(snapshot);
+        if (!readSnapshot(snapshotPath, sequence)) return false;
+    }
+    if (writer.getNumStacks() != numStacks || writer.getStackCapacity() != stackCapacity ||
+        sequence < writer.getBaseSequence()) {
+        return false;
+    }
+
+    // Replay silently and without journaling the replayed operations again
+    LotEventSink* sink = eventSink;
+    eventSink = nullptr;
+    journal = nullptr;
+    bool replayed = writer.replay(*this, sequence);
+    eventSink = sink;
+    if (!replayed) return false;
+
+    // The snapshot may be ahead of the journal's last synced record (saved
+    // without checkpoint); new records must be numbered after it
+    if (writer.sequence() < sequence && !writer.restart(sequence)) return false;
+    journal = &writer;
+    return true;
 }
 
 void ParkingLot::printParkingLotState() const {
     std::cout << "======= Parking Lot State =======\n";
-    std::cout << "Entrance Queue size: " << entranceQueue.size() << std::endl;
-    entranceQueue.printQueue();
+    {
+        OptionalLock<std::mutex> queueGuard(whenConcurrent(queueLock));
+        std::cout << "Entrance Queue size: " << entranceQueue.size() << std::endl;
+        entranceQueue.printQueue();
+    }
     std::cout << "Number of stacks: " << numStacks
               << ", Capacity per stack: " << stackCapacity << "\n\n";
 
     for (int i = 0; i < numStacks; ++i) {
+        OptionalLock<std::mutex> laneGuard(laneMutex(i));
         std::cout << "Stack " << (i + 1) << " (size: " << stacks[i].size()
                   << "/" << stacks[i].getCapacity() << "):\n";
         stacks[i].printStack();
@@ -177,18 +925,61 @@ void ParkingLot::printParkingLotState() const {
     }
 }
 
-// Search queue + all stacks — used to prevent duplicate car IDs
-bool ParkingLot::carAlreadyInSystem(int carId) const {
-    if (entranceQueue.contains(carId)) {
-        return true;
+void ParkingLot::indexPush(int lane, int carId) {
+    carIndex.set(carId, CarLocation{lane, stacks[lane].size() - 1});
+}
+
+void ParkingLot::indexRun(int lane, int count) {
+    // The cars are indexed already, so update the entries in place
+    int slot = stacks[lane].size() - 1;
+    const Car* car = stacks[lane].topCar();
+    for (int i = 0; i < count; ++i, car = car->next) {
+        *carIndex.find(car->carId) = CarLocation{lane, slot--};
     }
+}
 
-    for (int i = 0; i < numStacks; ++i) {
-        if (stacks[i].findPosition(carId) != -1) {
-            return true;
-        }
+void ParkingLot::touchLane(int lane) {
+    // Only the lock holder writes, so no read-modify-write instruction is needed
+    std::atomic<std::uint32_t> &version = laneVersions[lane];
+    version.store(version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void ParkingLot::laneChanged(int lane) {
+    touchLane(lane);
+    OptionalLock<std::mutex> freeGuard(whenConcurrent(freeLock));
+    freeLanes.set(lane, !stacks[lane].isFull());
+}
+
+void ParkingLot::indexLane(int lane) {
+    // find() never inserts or moves entries, so it is safe to call for
+    // different lanes from several threads under a shared indexLock
+    int slot = stacks[lane].size() - 1;
+    for (const Car* c = stacks[lane].topCar(); c != nullptr; c = c->next) {
+        carIndex.find(c->carId)->slot = slot--;
+    }
+}
+
+ThreadPool& ParkingLot::pool(int threads) const {
+    OptionalLock<std::mutex> poolGuard(whenConcurrent(poolLock));
+    // Another thread may be using the pool in concurrent mode, so never replace it there
+    if (!concurrent && workerPool != nullptr && threads > 0 && workerPool->size() != threads) {
+        delete workerPool;
+        workerPool = nullptr;
     }
-    return false;
+    if (workerPool == nullptr) {
+        workerPool = new ThreadPool(threads);
+    }
+    return *workerPool;
+}
+
+void ParkingLot::notify(LotOperation operation, LotStatus status, int carId,
+                        int stackIndex, int targetIndex, int topCarId, int carsMoved) const {
+    if (eventSink == nullptr) return;
+    eventSink->onEvent(LotEvent{operation, status, carId, stackIndex, targetIndex, topCarId, carsMoved});
+}
+
+bool ParkingLot::isConcurrent() const {
+    return concurrent;
 }
 
 int ParkingLot::getNumStacks() const {
@@ -197,4 +988,16 @@ int ParkingLot::getNumStacks() const {
 
 int ParkingLot::getStackCapacity() const {
     return stackCapacity;
-}
\ No newline at end of file
+}
+
+const Stack& ParkingLot::getStack(int stackIndex) const {
+    return stacks[stackIndex - 1];
+}
+
+std::uint32_t ParkingLot::getLaneVersion(int stackIndex) const {
+    return laneVersions[stackIndex - 1].load(std::memory_order_relaxed);
+}
+
+const Queue& ParkingLot::getEntranceQueue() const {
+    return entranceQueue;
+}
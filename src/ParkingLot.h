@@ -1,12 +1,40 @@
 #ifndef PARKINGLOT_H
 #define PARKINGLOT_H
 
-#include "stack.h"
+#include "Stack.h"
+#include "CarIndex.h"
 #include "Queue.h"
+#include "FreeLaneSet.h"
+#include "LotStatus.h"
+#include "LotEvent.h"
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+class Journal;
+class MpmcQueue;
+class RingQueue;
+class ThreadPool;
 
 // Represents the entire parking lot system:
 // One entrance queue
 // An array of stacks (lanes)
+//
+// Operations report their outcome as a LotStatus / result object and, if an
+// event sink is set, as a LotEvent. Without a sink nothing is formatted or printed.
+//
+// State changes can be recorded in a write-ahead Journal (setJournal) and the
+// lot rebuilt from a snapshot plus that journal (recover).
+//
+// Concurrent mode (constructor flag) makes every public operation thread-safe:
+// each stack has its own mutex, and the entrance queue, free-lane set and car
+// index have one each. Locks are always taken in this order, so operations on
+// different stacks run in parallel without deadlock:
+//   journalLock -> queueLock -> stack locks (ascending index) -> freeLock -> indexLock
+// journalLock is only taken while a journal is attached (see setJournal).
+// In the default single-threaded mode no locks are taken at all.
 class ParkingLot {
 private:
     int numStacks;
@@ -14,71 +42,302 @@ private:
     Stack* stacks;
     Queue entranceQueue;
 
+    // Where each car currently is, keyed by carId (see CarLocation)
+    CarIndex carIndex;
+
+    // Lanes that are not full, kept in sync after every push/pop
+    FreeLaneSet freeLanes;
+
+    // Per lane, bumped whenever its contents change (see getLaneVersion).
+    // Only written under the lane's lock; atomic so views may poll it.
+    std::atomic<std::uint32_t>* laneVersions;
+
+    LotEventSink* eventSink;  // nullptr = silent
+    Journal* journal;         // nullptr = not journaled
+
+    // Workers for the parallel operations, created on first use
+    // (mutable: const lookups may start it too)
+    mutable ThreadPool* workerPool;
+
+    // ** Concurrent mode **
+    bool concurrent;
+    std::mutex* laneLocks;               // one per stack, nullptr unless concurrent
+    mutable std::mutex journalLock;      // orders state changes while journaled
+    mutable std::mutex queueLock;
+    mutable std::mutex freeLock;         // guards freeLanes
+    mutable std::shared_mutex indexLock; // guards carIndex (shared for lookups)
+    mutable std::mutex poolLock;         // guards workerPool creation
+
+    // The given lock in concurrent mode, nullptr (= don't lock) otherwise
+    template <class Mutex>
+    Mutex* whenConcurrent(Mutex &m) const { return concurrent ? &m : nullptr; }
+
+    std::mutex* laneMutex(int lane) const { return laneLocks ? &laneLocks[lane] : nullptr; }
+
+    // journalLock in concurrent mode with a journal attached, nullptr otherwise
+    std::mutex* whenJournaled() const { return concurrent && journal ? &journalLock : nullptr; }
+
+    // Pool with the requested number of threads (0 = one per core).
+    // In concurrent mode the pool keeps the size it was first created with.
+    // Time Complexity: O(1), or O(t) when the pool is (re)created
+    ThreadPool& pool(int threads) const;
+
     bool isValidStackIndex(int stackIndex) const;
 
-    bool carAlreadyInSystem(int carId) const;
+    // Push car onto the first stack with free space, or drop it if there is none.
+    // Caller holds queueLock.
+    // Time Complexity: O(log_64 n) (plus retries when another thread fills the lane first)
+    ParkResult parkInFirstFreeLane(Car* car);
+
+    // Record that carId was just pushed onto stacks[lane].
+    // Caller holds the lane's lock and indexLock (exclusive).
+    // Time Complexity: O(1) average
+    void indexPush(int lane, int carId);
+
+    // Re-record the top count cars of stacks[lane], which were just moved
+    // there from another lane (their entries exist, only lane and slot change).
+    // Caller holds the lane's lock and indexLock (exclusive).
+    // Time Complexity: O(count) average
+    void indexRun(int lane, int count);
+
+    // Bump the version of stacks[lane] after its contents changed.
+    // Caller holds the lane's lock.
+    // Time Complexity: O(1)
+    void touchLane(int lane);
+
+    // Refresh the free-lane bit of stacks[lane] after its size changed
+    // (and touch the lane). Caller holds the lane's lock; takes freeLock itself.
+    // Time Complexity: O(log_64 n)
+    void laneChanged(int lane);
+
+    // Re-record the slot of every car in stacks[lane] (after a sort).
+    // Only updates existing entries' slots, which are read only under the lane's
+    // lock, so different lanes may be re-indexed concurrently.
+    // Caller holds the lane's lock and indexLock (shared is enough).
+    // Time Complexity: O(k) where k = number of cars in that stack
+    void indexLane(int lane);
+
+    // Forward an event to eventSink, if any. In concurrent mode the sink is
+    // called from the operating thread, possibly with stack locks held, so it
+    // must be thread-safe and must not call back into the lot.
+    // Time Complexity: O(1) (plus whatever the sink does)
+    void notify(LotOperation operation, LotStatus status, int carId = 0,
+                int stackIndex = 0, int targetIndex = 0, int topCarId = 0,
+                int carsMoved = 0) const;
+
+    // saveSnapshot without taking journalLock, recording journal position sequence.
+    // Time Complexity: O(N + n) for N cars and n stacks
+    bool writeSnapshot(const char* path, std::uint64_t sequence) const;
+
+    // loadSnapshot that also reports the journal position the snapshot covers.
+    // Time Complexity: O(N + n) for N cars and n stacks
+    bool readSnapshot(const char* path, std::uint64_t &sequence);
 
 public:
+    // concurrentMode = true makes all operations safe to call from several threads.
     // Time Complexity: O(n)
-    ParkingLot(int nStacks, int capacityPerStack);
+    ParkingLot(int nStacks, int capacityPerStack, bool concurrentMode = false);
 
     // Time Complexity: O(n * m) (n for each stack and m for the size of each stack)
     ~ParkingLot();
 
+    // Report every operation outcome to sink (not owned); nullptr turns reporting off.
+    // Time Complexity: O(1)
+    void setEventSink(LotEventSink* sink);
+
+    // Append every operation that changes the lot to writer (not owned);
+    // nullptr stops journaling. Lookups are not journaled, nor are operations
+    // that fail without changing anything. In concurrent mode, state changes are
+    // serialized while a journal is attached (lookups still run in parallel),
+    // so the journal order is a valid replay order. Set it before sharing the lot.
+    // Time Complexity: O(1)
+    void setJournal(Journal* writer);
+
     // ** Entrance / Enqueue **
 
-    // Time Complexity: O(n * m)
-    void addCarToEntrance(int carId);
+    // Returns Ok or DuplicateCar.
+    // Time Complexity: O(1) average
+    LotStatus addCarToEntrance(int carId);
+
+    // Add count cars in order without reporting events. Each result is Ok or
+    // DuplicateCar (already in the lot, or earlier in the same batch).
+    // Time Complexity: O(count) average
+    std::vector<LotStatus> addCarsToEntrance(const int* carIds, int count);
+
+    // Drain up to maxCars from a bounded gate in front of the lot with one
+    // RingQueue::dequeueBatch and admit them as addCarsToEntrance does
+    // (duplicates are dropped). Returns the number of cars admitted.
+    // The gate itself is not locked; only one thread may drain it.
+    // Time Complexity: O(k) average for k cars taken from the gate
+    int admitFromGate(RingQueue &gate, int maxCars);
+
+    // Same for an entrance shared by several gates: take up to maxCars from
+    // the lock-free queue and admit them as addCarsToEntrance does. Several
+    // workers may drain the same queue at once (in concurrent mode); each
+    // call admits the cars it took in the order it took them.
+    // Time Complexity: O(k) average for k cars taken from the queue
+    int admitFromQueue(MpmcQueue &queue, int maxCars);
 
     // ** Parking operations **
 
     // Dequeue car and push into the first stack that has free space.
-    // If all stacks are full, prints "Parking full".
-    // Time Complexity: O(n)
-    void parkCarInFirstAvailableStack();
+    // Returns Ok, QueueEmpty, or ParkingFull (the car is dropped).
+    // Time Complexity: O(log_64 n) lookup in freeLanes, effectively O(1)
+    ParkResult parkCarInFirstAvailableStack();
+
+    // Park up to maxCars from the front of the queue in one sweep over the
+    // free lanes (same lane choice as repeated parkCarInFirstAvailableStack),
+    // without reporting events. Stops when every stack is full; the remaining cars stay
+    // queued. Returns one result per parked car, in queue order.
+    // Time Complexity: O(p + l * log_64 n) where p = cars parked, l = lanes filled
+    std::vector<ParkResult> parkBatch(int maxCars);
 
     // Dequeue car and push into a specific stack (1-based index).
+    // Returns Ok, InvalidStack, QueueEmpty, or StackFull (the car is dropped).
     // Time Complexity: O(1) check if stack index valid, O(1) push; overall O(1)
-    void parkCarInSpecificStack(int stackIndex);
+    ParkResult parkCarInSpecificStack(int stackIndex);
 
     // ** Find **
 
     // Find car by ID.
     // Outputs stackIndex (1-based) and position (1-based) from top of stack.
     // Returns true if found, false otherwise.
-    // Time Complexity: O(n * m) where m is capacity per stack.
+    // Time Complexity: O(1) average (hash lookup in carIndex).
     bool findCar(int carId, int &stackIndex, int &position) const;
 
+    // Find car by scanning the stacks instead of using carIndex (for cold
+    // lookups and for cross-checking the index). Same results as findCar.
+    // threads = 1 scans on the calling thread; otherwise the stacks are split
+    // across the thread pool (0 = one thread per core), and a worker stops as
+    // soon as a lower-numbered stack is known to hold the car.
+    // Time Complexity: O(n * m) work, about O(n * m / t) wall-clock on t threads
+    bool findCarByScan(int carId, int &stackIndex, int &position, int threads = 1) const;
+
     // ** Exit **
 
     // Remove car only if it is at the top of the specified stack.
-    // Returns true if removed, false otherwise.
+    // Returns Ok if removed, otherwise InvalidStack, StackEmpty or NotOnTop.
     // Time Complexity: O(1)
-    bool exitCarFromStackTop(int carId, int stackIndex);
+    LotStatus exitCarFromStackTop(int carId, int stackIndex);
+
+    // Take car out wherever it is parked: relocate the cars above it into
+    // other stacks with free space, then remove it. That is p - 1 relocations
+    // for a car at position p, the fewest possible; each blocker moves once.
+    // Free lanes are found through freeLanes (first non-full ones, skipping
+    // the car's own), and each target takes its run in one
+    // Stack::transferTopTo, in the same order as moving the cars one by one.
+    // Nothing changes unless the other stacks hold every blocker.
+    // Status is Ok (moves lists the relocations in order), CarNotFound or
+    // NotEnoughSpace. Journaled as one Retrieve record, which replays to the
+    // same relocations.
+    // Time Complexity: O(p + l * log_64 n) for l target lanes used; in
+    // concurrent mode also O(log p) retries when the first lanes tried lack room
+    RetrieveResult retrieveCar(int carId);
 
     // ** Sort **
 
-    // Sort a specific stack using recursive merge sort on its linked list.
-    // Time Complexity: O(k log k) where k is number of cars in that stack.
-    void sortStack(int stackIndex);
+    // Sort a specific stack by car ID (ascending from the top) on its linked list:
+    // merge sort for short lanes, radix sort from Stack::RADIX_THRESHOLD cars up.
+    // Time Complexity: O(k log k) below the threshold, O(k) above it, where k is
+    // number of cars in that stack (plus O(k) to re-index the lane).
+    // Returns Ok or InvalidStack.
+    LotStatus sortStack(int stackIndex);
+
+    // Sort stacks firstIndex..lastIndex (1-based, inclusive) like sortStack,
+    // spreading the lanes over a work-stealing thread pool. threads = 0 uses one
+    // thread per core; threads = 1 sorts on the calling thread.
+    // Returns Ok or InvalidStack.
+    // Time Complexity: O(C / t) wall-clock for C cars in the range on t threads
+    // (O(k) or O(k log k) work per lane as in sortStack)
+    LotStatus sortStacks(int firstIndex, int lastIndex, int threads = 0);
+
+    // sortStacks over every stack.
+    // Time Complexity: O(C / t), C = total cars parked
+    LotStatus sortAllStacks(int threads = 0);
 
     // ** Move Between Stacks **
 
     // Move as many cars as possible from stack i to stack j.
-    // If stack j fills up, continue with j+1, j+2, ...
-    // Time Complexity: O(T) where T is total number of cars moved plus number of stacks visited.
-    void moveBetweenStacks(int sourceIndex, int targetIndex);
+    // If stack j fills up, continue with the next non-full stacks after j
+    // (never spilling back into stack i itself). Each target takes its run of
+    // cars in one Stack::transferTopTo, so the order matches moving them one
+    // at a time, and one MoveStacks event reports the total.
+    // Status is Ok (source emptied), InvalidStack, SameStack, StackEmpty
+    // (source already empty) or NotEnoughSpace (some cars remain).
+    // Time Complexity: O(T) where T is total number of cars moved plus number of
+    // non-full stacks visited (full stacks are skipped via freeLanes).
+    MoveResult moveBetweenStacks(int sourceIndex, int targetIndex);
+
+    // Move only the top car of stack i onto stack j.
+    // Returns Ok, InvalidStack, SameStack, StackEmpty (source) or StackFull (target).
+    // Time Complexity: O(log_64 n) to refresh freeLanes, effectively O(1)
+    LotStatus moveTopCar(int sourceIndex, int targetIndex);
+
+    // ** Persistence **
+
+    // Write the whole state to a versioned binary snapshot: the entrance queue
+    // in order, every stack top to bottom with its capacity, and the journal
+    // sequence it covers. The file is written next to path and renamed over
+    // it, so an existing snapshot is never left half-written. Returns false
+    // if writing fails.
+    // Time Complexity: O(N + n) for N cars and n stacks
+    bool saveSnapshot(const char* path) const;
+
+    // Replace the whole state, shape included, with a snapshot. Stacks are
+    // linked directly from the file and the index is rebuilt in one pass;
+    // no events are reported. Returns false and leaves the lot unchanged if
+    // the file is unreadable, from another version or inconsistent.
+    // Not thread-safe even in concurrent mode: load before sharing the lot.
+    // Time Complexity: O(N + n) for N cars and n stacks
+    bool loadSnapshot(const char* path);
+
+    // Snapshot to path, then restart the attached journal from that point, so
+    // it only holds what happened since. A crash in between is harmless:
+    // recover skips journal records the snapshot already covers.
+    // Returns false (journal untouched) if there is no journal or saving fails.
+    // Time Complexity: O(N + n), plus two fsyncs
+    bool checkpoint(const char* snapshotPath);
+
+    // Rebuild the lot after a restart: load the snapshot at snapshotPath (if
+    // the file exists; otherwise start from the current, normally empty,
+    // state), replay the journal records it does not cover, and attach
+    // journal so new operations continue it. journal must be for this shape.
+    // No events are reported. Returns false, possibly after loading the
+    // snapshot, if the snapshot is unreadable, the journal is not ok(), has
+    // another shape or starts after the snapshot (records are missing).
+    // Not thread-safe even in concurrent mode: recover before sharing the lot.
+    // Time Complexity: O(N + n + r) for r replayed records
+    bool recover(const char* snapshotPath, Journal &journal);
 
     // ** Display / Debug **
 
     // Time Complexity: O(n * m)
     void printParkingLotState() const;
 
+    // Time Complexity: O(1)
+    bool isConcurrent() const;
+
     // Time Complexity: O(1)
     int getNumStacks() const;
 
     // Time Complexity: O(1)
     int getStackCapacity() const;
+
+    // Read-only view of a stack (1-based index, must be valid). Not
+    // synchronized: in concurrent mode, only use it while no other thread
+    // is changing the lot.
+    // Time Complexity: O(1)
+    const Stack& getStack(int stackIndex) const;
+
+    // Counter that changes whenever the stack (1-based index, must be valid)
+    // does: push, pop, sort or snapshot load. A view can compare it with the
+    // value it last drew to skip unchanged lanes. Safe from any thread.
+    // Time Complexity: O(1)
+    std::uint32_t getLaneVersion(int stackIndex) const;
+
+    // Read-only view of the entrance queue; same caveat as getStack.
+    // Time Complexity: O(1)
+    const Queue& getEntranceQueue() const;
 };
 
 #endif // PARKINGLOT_H
@@ -37,6 +37,24 @@ bool Queue::dequeue(int &carId) {
     return true;
 }
 
+const Car* Queue::frontCar() const {
+    return frontNode;
+}
+
+Car* Queue::detachFront() {
+    if (isEmpty()) {
+        return nullptr;
+    }
+    Car* node = frontNode;
+    frontNode = frontNode->next;
+    if (frontNode == nullptr) {
+        rearNode = nullptr;  // Queue becomes empty
+    }
+    node->next = nullptr;
+    --currentSize;
+    return node;
+}
+
 bool Queue::front(int &carId) const {
     if (isEmpty()) {
         return false;
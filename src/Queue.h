@@ -27,7 +27,16 @@ public:
 
     // Time Complexity: O(1)
     bool front(int &carId) const;
-    
+
+    // Unlink the front node and hand it to the caller (nullptr if empty).
+    // The node is not freed, so it can be spliced into a Stack.
+    // Time Complexity: O(1)
+    Car* detachFront();
+
+    // Read-only access to the front node for walking the queue (front -> rear).
+    // Time Complexity: O(1)
+    const Car* frontCar() const;
+
     // Time Complexity: O(n)
     bool contains(int carId) const;
 
@@ -0,0 +1,121 @@
+#include "RingQueue.h"
+#include <cstring>
+#include <iostream>
+
+static const int INITIAL_BUFFER = 16;
+static const int MAX_PREALLOCATED = 1 << 16;  // larger limits grow on demand
+
+// Smallest power of two >= n (1 <= n <= MAX_CARS)
+static int roundUpPow2(int n) {
+    int p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+RingQueue::RingQueue(int maxCars)
+    : head(0), currentSize(0), limit(maxCars <= 0 ? 0 : maxCars < MAX_CARS ? maxCars : MAX_CARS) {
+    // A bounded queue never needs more than its limit, so allocate it up
+    // front unless the limit is large
+    bufferSize = limit > 0 ? roundUpPow2(limit < MAX_PREALLOCATED ? limit : MAX_PREALLOCATED)
+                           : INITIAL_BUFFER;
+    buffer = new int[bufferSize];
+}
+
+RingQueue::~RingQueue() {
+    delete [] buffer;
+}
+
+bool RingQueue::isEmpty() const {
+    return currentSize == 0;
+}
+
+bool RingQueue::isFull() const {
+    return limit > 0 && currentSize >= limit;
+}
+
+bool RingQueue::enqueue(int carId) {
+    if (isFull()) return false;
+    if (currentSize == bufferSize) {
+        if (bufferSize == MAX_CARS) return false;  // at the ceiling
+        grow();
+    }
+    buffer[(head + currentSize) & (bufferSize - 1)] = carId;
+    ++currentSize;
+    return true;
+}
+
+bool RingQueue::dequeue(int &carId) {
+    if (isEmpty()) return false;
+    carId = buffer[head];
+    head = (head + 1) & (bufferSize - 1);
+    --currentSize;
+    return true;
+}
+
+int RingQueue::dequeueBatch(int* out, int k) {
+    if (k > currentSize) k = currentSize;
+    if (k <= 0) return 0;
+
+    // At most two contiguous runs: head..end of buffer, then the wrapped part
+    int firstRun = bufferSize - head;
+    if (firstRun > k) firstRun = k;
+    std::memcpy(out, buffer + head, sizeof(int) * firstRun);
+    std::memcpy(out + firstRun, buffer, sizeof(int) * (k - firstRun));
+
+    head = (head + k) & (bufferSize - 1);
+    currentSize -= k;
+    return k;
+}
+
+bool RingQueue::front(int &carId) const {
+    if (isEmpty()) return false;
+    carId = buffer[head];
+    return true;
+}
+
+// Search for car ID — used to prevent duplicates
+bool RingQueue::contains(int carId) const {
+    for (int i = 0; i < currentSize; ++i) {
+        if (buffer[(head + i) & (bufferSize - 1)] == carId) return true;
+    }
+    return false;
+}
+
+int RingQueue::size() const {
+    return currentSize;
+}
+
+int RingQueue::getLimit() const {
+    return limit;
+}
+
+void RingQueue::printQueue() const {
+    std::cout << "Entrance Queue (front -> rear): ";
+    for (int i = 0; i < currentSize; ++i) {
+        std::cout << buffer[(head + i) & (bufferSize - 1)];
+        if (i + 1 < currentSize) {
+            std::cout << " <- ";
+        }
+    }
+    std::cout << std::endl;
+}
+
+void RingQueue::clear() {
+    head = 0;
+    currentSize = 0;
+}
+
+// Double the buffer, unrolling the contents so the front is at index 0.
+// Only called below MAX_CARS, so the doubling cannot overflow.
+void RingQueue::grow() {
+    int newSize = bufferSize * 2;
+    int* bigger = new int[newSize];
+    int firstRun = bufferSize - head;
+    if (firstRun > currentSize) firstRun = currentSize;
+    std::memcpy(bigger, buffer + head, sizeof(int) * firstRun);
+    std::memcpy(bigger + firstRun, buffer, sizeof(int) * (currentSize - firstRun));
+    delete [] buffer;
+    buffer = bigger;
+    bufferSize = newSize;
+    head = 0;
+}
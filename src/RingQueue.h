@@ -0,0 +1,71 @@
+#ifndef RINGQUEUE_H
+#define RINGQUEUE_H
+
+// Entrance queue stored as a contiguous ring buffer of car IDs.
+// Same interface as Queue, plus an optional capacity limit: when the limit is
+// reached enqueue() returns false so the gate can hold the car back.
+// Without a limit the buffer doubles as needed, up to MAX_CARS.
+// ParkingLot::admitFromGate drains one into the lot in batches.
+class RingQueue {
+private:
+    int* buffer;
+    int bufferSize;   // always a power of two
+    int head;         // index of the front car
+    int currentSize;
+    int limit;        // 0 = unbounded
+
+    RingQueue(const RingQueue&) = delete;
+    RingQueue& operator=(const RingQueue&) = delete;
+
+    // Time Complexity: O(n)
+    void grow();
+
+public:
+    // Largest buffer (a power of two); limits above it are clamped to it
+    static const int MAX_CARS = 1 << 30;
+
+    // maxCars = 0 means unbounded.
+    // Time Complexity: O(1)
+    RingQueue(int maxCars = 0);
+
+    // Time Complexity: O(1)
+    ~RingQueue();
+
+    // Time Complexity: O(1)
+    bool isEmpty() const;
+
+    // Time Complexity: O(1)
+    bool isFull() const;
+
+    // Returns false (and does nothing) when the capacity limit (at most
+    // MAX_CARS) is reached.
+    // Time Complexity: O(1) amortized
+    bool enqueue(int carId);
+
+    // Time Complexity: O(1)
+    bool dequeue(int &carId);
+
+    // Dequeue up to k cars into out (front first); returns how many were taken.
+    // Time Complexity: O(k)
+    int dequeueBatch(int* out, int k);
+
+    // Time Complexity: O(1)
+    bool front(int &carId) const;
+
+    // Time Complexity: O(n)
+    bool contains(int carId) const;
+
+    // Time Complexity: O(1)
+    int size() const;
+
+    // Time Complexity: O(1)
+    int getLimit() const;
+
+    // Time Complexity: O(n)
+    void printQueue() const;
+
+    // Time Complexity: O(1)
+    void clear();
+};
+
+#endif // RINGQUEUE_H
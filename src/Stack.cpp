@@ -1,4 +1,6 @@
 #include "Stack.h"
+#include "CarPool.h"
+#include <new>
 
 Stack::Stack(int cap) : topNode(nullptr), currentSize(0), capacity(cap) {}
 
@@ -23,6 +25,45 @@ bool Stack::push(int carId) {
     return true;
 }
 
+bool Stack::pushNode(Car* node) {
+    if (isFull()) return false;
+    node->next = topNode;
+    topNode = node;
+    ++currentSize;
+    return true;
+}
+
+Car* Stack::popNode() {
+    if (isEmpty()) return nullptr;
+    Car* node = topNode;
+    topNode = topNode->next;
+    node->next = nullptr;
+    --currentSize;
+    return node;
+}
+
+int Stack::transferTopTo(Stack &target, int maxCount) {
+    int count = maxCount;
+    if (count > currentSize) count = currentSize;
+    if (count > target.capacity - target.currentSize) count = target.capacity - target.currentSize;
+    if (count <= 0) return 0;
+
+    // Size and capacity were settled above, so each node is a bare relink
+    Car* top = topNode;
+    Car* targetTop = target.topNode;
+    for (int i = 0; i < count; ++i) {
+        Car* node = top;
+        top = node->next;
+        node->next = targetTop;
+        targetTop = node;
+    }
+    topNode = top;
+    target.topNode = targetTop;
+    currentSize -= count;
+    target.currentSize += count;
+    return count;
+}
+
 bool Stack::pop(int &carId) {
     if (isEmpty()) return false;
     Car* temp = topNode;
@@ -39,6 +80,32 @@ bool Stack::peek(int &carId) const {
     return true;
 }
 
+bool Stack::assign(const int* carIdsTopFirst, int count) {
+    if (count < 0 || count > capacity) return false;
+    clear();
+    // Build from the bottom up so each node links to the one already built.
+    // Nodes come from the pool in batches and are constructed in place;
+    // they are freed by the usual delete.
+    const int BATCH = 256;
+    void* raw[BATCH];
+    int i = count - 1;
+    while (i >= 0) {
+        int n = i + 1 < BATCH ? i + 1 : BATCH;
+        CarPool::allocateBatch(raw, (std::size_t)n);
+        for (int k = 0; k < n; ++k, --i) {
+            Car* node = ::new (raw[k]) Car(carIdsTopFirst[i]);
+            node->next = topNode;
+            topNode = node;
+        }
+    }
+    currentSize = count;
+    return true;
+}
+
+const Car* Stack::topCar() const {
+    return topNode;
+}
+
 void Stack::printStack() const {
     Car* current = topNode;
     int pos = 1;
@@ -58,7 +125,11 @@ int Stack::getCapacity() const {
 }
 
 void Stack::sort() {
-    topNode = mergeSort(topNode);
+    if (currentSize >= RADIX_THRESHOLD) {
+        topNode = radixSort(topNode);
+    } else {
+        topNode = mergeSort(topNode, currentSize);
+    }
 }
 
 // Find position from top (1 = top), return -1 if not found
@@ -87,50 +158,101 @@ void Stack::clear() {
 
 // --- merge sort helpers ---
 
-Car* Stack::mergeSort(Car* head) {
+// Bottom-up merge sort: merge adjacent runs of width 1, 2, 4, ... in place.
+// Uses a constant amount of stack regardless of the lane length.
+Car* Stack::mergeSort(Car* head, int length) {
     if (head == nullptr || head->next == nullptr) return head;
 
-    Car* a;
-    Car* b;
-    splitList(head, &a, &b);
+    Car dummy;
+    dummy.next = head;
 
-    a = mergeSort(a);
-    b = mergeSort(b);
+    for (int width = 1; width < length; width *= 2) {
+        Car* tail = &dummy;
+        Car* current = dummy.next;
+        while (current != nullptr) {
+            Car* left = current;
+            Car* right = splitAfter(left, width);
+            current = splitAfter(right, width);
+            tail = mergeRuns(left, right, tail);
+        }
+    }
+    return dummy.next;
+}
 
-    return sortedMerge(a, b);
+// Radix key: flipping the sign bit makes unsigned order match signed int order
+static inline unsigned radixKey(int carId) {
+    return (unsigned)carId ^ 0x80000000u;
 }
 
-// Split list into two halves using slow/fast pointer
-void Stack::splitList(Car* source, Car** frontRef, Car** backRef) {
-    Car* slow = source;
-    Car* fast = source->next;
+// Stable LSD radix sort, 8 bits per pass, by relinking nodes into 256 bucket lists.
+// Bytes that are identical in every key are skipped.
+Car* Stack::radixSort(Car* head) {
+    if (head == nullptr || head->next == nullptr) return head;
 
-    while (fast != nullptr) {
-        fast = fast->next;
-        if (fast != nullptr) {
-            slow = slow->next;
-            fast = fast->next;
-        }
+    unsigned first = radixKey(head->carId);
+    unsigned differing = 0;
+    for (Car* c = head->next; c != nullptr; c = c->next) {
+        differing |= radixKey(c->carId) ^ first;
     }
 
-    *frontRef = source;
-    *backRef = slow->next;
-    slow->next = nullptr;
-}
+    Car* bucketHead[256];
+    Car* bucketTail[256];
+    for (int shift = 0; shift < 32; shift += 8) {
+        if (((differing >> shift) & 0xFF) == 0) continue;
 
-// Merge two sorted lists (ascending order)
-Car* Stack::sortedMerge(Car* a, Car* b) {
-    if (!a) return b;
-    if (!b) return a;
+        for (int b = 0; b < 256; ++b) bucketHead[b] = nullptr;
+        for (Car* c = head; c != nullptr; c = c->next) {
+            unsigned b = (radixKey(c->carId) >> shift) & 0xFF;
+            if (bucketHead[b] == nullptr) {
+                bucketHead[b] = c;
+            } else {
+                bucketTail[b]->next = c;
+            }
+            bucketTail[b] = c;
+        }
 
-    Car* result = nullptr;
+        // Concatenate the buckets in order
+        Car* tail = nullptr;
+        for (int b = 0; b < 256; ++b) {
+            if (bucketHead[b] == nullptr) continue;
+            if (tail == nullptr) {
+                head = bucketHead[b];
+            } else {
+                tail->next = bucketHead[b];
+            }
+            tail = bucketTail[b];
+        }
+        tail->next = nullptr;
+    }
+    return head;
+}
 
-    if (a->carId <= b->carId) {
-        result = a;
-        result->next = sortedMerge(a->next, b);
-    } else {
-        result = b;
-        result->next = sortedMerge(a, b->next);
+// Cut the list after count nodes; returns the remainder (or nullptr)
+Car* Stack::splitAfter(Car* head, int count) {
+    for (int i = 1; head != nullptr && i < count; ++i) {
+        head = head->next;
+    }
+    if (head == nullptr) return nullptr;
+    Car* rest = head->next;
+    head->next = nullptr;
+    return rest;
+}
+
+// Merge two sorted runs (ascending, stable) after tail; returns the new tail
+Car* Stack::mergeRuns(Car* a, Car* b, Car* tail) {
+    while (a != nullptr && b != nullptr) {
+        if (a->carId <= b->carId) {
+            tail->next = a;
+            a = a->next;
+        } else {
+            tail->next = b;
+            b = b->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = (a != nullptr) ? a : b;
+    while (tail->next != nullptr) {
+        tail = tail->next;
     }
-    return result;
+    return tail;
 }
\ No newline at end of file
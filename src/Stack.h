@@ -9,12 +9,18 @@ private:
     int currentSize;
     int capacity;
 
-    // Merge sort helper functions
-    Car* mergeSort(Car* head);
-    void splitList(Car* source, Car** frontRef, Car** backRef);
-    Car* sortedMerge(Car* a, Car* b);
+    // Merge sort helper functions (bottom-up, no recursion)
+    Car* mergeSort(Car* head, int length);
+    static Car* splitAfter(Car* head, int count);
+    static Car* mergeRuns(Car* a, Car* b, Car* tail);
+
+    // LSD radix sort on carId, one bucket-list pass per byte that varies
+    Car* radixSort(Car* head);
 
 public:
+    // Lanes with at least this many cars are sorted with radix sort
+    static const int RADIX_THRESHOLD = 64;
+
     // Time Complexity: O(1)
     Stack(int cap = 0);
 
@@ -36,6 +42,30 @@ public:
     // Time Complexity: O(1)
     bool peek(int &carId) const;
 
+    // Link an existing node on top without allocating; false if full
+    // (the caller keeps ownership of the node in that case).
+    // Time Complexity: O(1)
+    bool pushNode(Car* node);
+
+    // Unlink the top node and hand it to the caller (nullptr if empty).
+    // Time Complexity: O(1)
+    Car* popNode();
+
+    // Move the top min(maxCount, size, target's free space) cars onto target
+    // by relinking their nodes, in the same order as that many popNode /
+    // pushNode pairs (the run ends up reversed). Returns the number moved.
+    // Time Complexity: O(c) pointer updates for c cars moved, no allocation
+    int transferTopTo(Stack &target, int maxCount);
+
+    // Replace the contents with count cars given top first, linking the nodes
+    // directly (bulk restore). False, and nothing changed, if count exceeds the capacity.
+    // Time Complexity: O(k + count) where k = number of cars in stack before
+    bool assign(const int* carIdsTopFirst, int count);
+
+    // Read-only access to the top node for walking the lane (top -> bottom).
+    // Time Complexity: O(1)
+    const Car* topCar() const;
+
     // Time Complexity: O(k) where k = number of cars in stack
     void printStack() const;
 
@@ -45,7 +75,10 @@ public:
     // Time Complexity: O(1)
     int getCapacity() const;
 
-    // Time Complexity: O(k log k) where k = number of cars in stack
+    // Ascending from the top. Iterative merge sort, O(1) extra space (no recursion),
+    // or LSD radix sort on carId from RADIX_THRESHOLD cars up.
+    // Time Complexity: O(k log k) below the threshold, O(k) above it,
+    // where k = number of cars in stack
     void sort();
 
     // Time Complexity: O(k) where k = number of cars in stack
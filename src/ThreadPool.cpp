@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+    : pending(0), stopping(false), nextQueue(0) {
+    if (threadCount <= 0) {
+        threadCount = (int)std::thread::hardware_concurrency();
+        if (threadCount <= 0) threadCount = 1;
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (int i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> guard(sleepLock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread &t : threads) {
+        t.join();
+    }
+}
+
+int ThreadPool::size() const {
+    return (int)threads.size();
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    WorkerQueue &q = *queues[nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size()];
+    {
+        std::lock_guard<std::mutex> guard(q.lock);
+        q.tasks.push_back(std::move(task));
+    }
+    {
+        // Counted under sleepLock so a worker cannot miss the wake-up
+        std::lock_guard<std::mutex> guard(sleepLock);
+        ++pending;
+    }
+    wake.notify_one();
+}
+
+bool ThreadPool::runOne(int self) {
+    std::function<void()> task;
+    int n = (int)queues.size();
+
+    if (self >= 0) {
+        WorkerQueue &own = *queues[self];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+        }
+    }
+    for (int k = 1; !task && k <= n; ++k) {
+        WorkerQueue &victim = *queues[(self + k + n) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+        }
+    }
+
+    if (!task) return false;
+    --pending;
+    task();
+    return true;
+}
+
+void ThreadPool::workerLoop(int self) {
+    for (;;) {
+        if (runOne(self)) continue;
+
+        std::unique_lock<std::mutex> lk(sleepLock);
+        wake.wait(lk, [this] { return stopping || pending.load() > 0; });
+        if (stopping && pending.load() == 0) return;
+    }
+}
+
+void ThreadPool::parallelFor(int begin, int end, int grain,
+                             const std::function<void(int, int)> &body) {
+    if (begin >= end) return;
+    if (grain < 1) grain = 1;
+
+    int chunks = (end - begin + grain - 1) / grain;
+    std::atomic<int> remaining(chunks);
+    std::mutex doneLock;
+    std::condition_variable done;
+
+    for (int lo = begin; lo < end; lo += grain) {
+        int hi = (end - lo > grain) ? lo + grain : end;
+        submit([&, lo, hi] {
+            body(lo, hi);
+            if (remaining.fetch_sub(1) == 1) {
+                // Notify while holding the lock: the caller cannot return (and
+                // destroy doneLock/done) until this guard is released
+                std::lock_guard<std::mutex> guard(doneLock);
+                done.notify_all();
+            }
+        });
+    }
+
+    // Help instead of idling, then wait for chunks still running elsewhere
+    while (remaining.load() > 0 && runOne(-1)) {
+    }
+    std::unique_lock<std::mutex> lk(doneLock);
+    done.wait(lk, [&] { return remaining.load() == 0; });
+}
@@ -0,0 +1,61 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads with one task deque each.
+// A worker runs its own newest task first and, when its deque is empty,
+// steals the oldest task from another worker.
+class ThreadPool {
+private:
+    struct WorkerQueue {
+        std::mutex lock;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex sleepLock;
+    std::condition_variable wake;
+    std::atomic<int> pending;      // submitted tasks not yet taken
+    bool stopping;
+    std::atomic<unsigned> nextQueue;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Take one task (own deque first unless self == -1, then steal) and run it.
+    // Returns false if every deque was empty.
+    bool runOne(int self);
+
+    void workerLoop(int self);
+
+public:
+    // threadCount <= 0 uses std::thread::hardware_concurrency().
+    // Time Complexity: O(t) thread start-ups
+    ThreadPool(int threadCount = 0);
+
+    // Finishes queued tasks, then joins the workers.
+    ~ThreadPool();
+
+    // Time Complexity: O(1)
+    int size() const;
+
+    // Time Complexity: O(1)
+    void submit(std::function<void()> task);
+
+    // Call body(lo, hi) on chunks of at most grain items covering [begin, end)
+    // and wait until all chunks are done. The calling thread helps run chunks.
+    // Time Complexity: O((end - begin) / grain) task submissions
+    void parallelFor(int begin, int end, int grain,
+                     const std::function<void(int, int)> &body);
+};
+
+#endif // THREADPOOL_H
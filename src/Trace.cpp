@@ -0,0 +1,226 @@
+#include "Trace.h"
+#include <cstring>
+
+namespace {
+
+const char MAGIC[4] = {'P', 'L', 'T', 'R'};
+
+void putVarint(std::vector<unsigned char> &out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((unsigned char)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((unsigned char)value);
+}
+
+// Small magnitudes of either sign map to small unsigned values
+std::uint32_t zigzag(int value) {
+    return ((std::uint32_t)value << 1) ^ (std::uint32_t)(value >> 31);
+}
+
+int unzigzag(std::uint32_t value) {
+    return (int)((value >> 1) ^ (0u - (value & 1)));
+}
+
+// At most 5 bytes for 32 bits
+bool getVarint(const unsigned char* &p, const unsigned char* end, std::uint32_t &value) {
+    std::uint32_t result = 0;
+    for (int shift = 0; shift < 35 && p != end; shift += 7) {
+        unsigned char byte = *p++;
+        result |= (std::uint32_t)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) {
+            value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool getInt(const unsigned char* &p, const unsigned char* end, int &value) {
+    std::uint32_t raw;
+    if (!getVarint(p, end, raw) || raw > 0x7fffffffu) return false;
+    value = (int)raw;
+    return true;
+}
+
+bool getCarId(const unsigned char* &p, const unsigned char* end, int &carId) {
+    std::uint32_t raw;
+    if (!getVarint(p, end, raw)) return false;
+    carId = unzigzag(raw);
+    return true;
+}
+
+} // namespace
+
+void appendTraceRecord(std::vector<unsigned char> &out, const TraceRecord &record) {
+    out.push_back((unsigned char)record.op);
+    switch (record.op) {
+        case TraceOp::Arrive:
+        case TraceOp::Find:
+        case TraceOp::Retrieve:
+            putVarint(out, zigzag(record.carId));
+            break;
+        case TraceOp::ParkFirst:
+            break;
+        case TraceOp::ParkSpecific:
+        case TraceOp::Sort:
+            putVarint(out, (std::uint32_t)record.stackIndex);
+            break;
+        case TraceOp::Exit:
+            putVarint(out, zigzag(record.carId));
+            putVarint(out, (std::uint32_t)record.stackIndex);
+            break;
+        case TraceOp::Move:
+        case TraceOp::MoveTop:
+            putVarint(out, (std::uint32_t)record.stackIndex);
+            putVarint(out, (std::uint32_t)record.targetIndex);
+            break;
+    }
+}
+
+bool readTraceRecord(const unsigned char* &cursor, const unsigned char* end, TraceRecord &record) {
+    const unsigned char* p = cursor;
+    if (p == end) return false;
+
+    TraceRecord r = {(TraceOp)*p++, 0, 0, 0};
+    bool complete;
+    switch (r.op) {
+        case TraceOp::Arrive:
+        case TraceOp::Find:
+        case TraceOp::Retrieve:
+            complete = getCarId(p, end, r.carId);
+            break;
+        case TraceOp::ParkFirst:
+            complete = true;
+            break;
+        case TraceOp::ParkSpecific:
+        case TraceOp::Sort:
+            complete = getInt(p, end, r.stackIndex);
+            break;
+        case TraceOp::Exit:
+            complete = getCarId(p, end, r.carId) && getInt(p, end, r.stackIndex);
+            break;
+        case TraceOp::Move:
+        case TraceOp::MoveTop:
+            complete = getInt(p, end, r.stackIndex) && getInt(p, end, r.targetIndex);
+            break;
+        default:
+            complete = false;  // unknown op byte
+            break;
+    }
+    if (!complete) return false;
+    record = r;
+    cursor = p;
+    return true;
+}
+
+bool isKnownTraceOp(unsigned char op) {
+    return op >= (unsigned char)TraceOp::Arrive && op <= (unsigned char)TraceOp::Retrieve;
+}
+
+bool applyTraceRecord(ParkingLot &lot, const TraceRecord &record) {
+    switch (record.op) {
+        case TraceOp::Arrive:
+            return lot.addCarToEntrance(record.carId) == LotStatus::Ok;
+        case TraceOp::ParkFirst:
+            return lot.parkCarInFirstAvailableStack().status == LotStatus::Ok;
+        case TraceOp::ParkSpecific:
+            return lot.parkCarInSpecificStack(record.stackIndex).status == LotStatus::Ok;
+        case TraceOp::Find: {
+            int stackIndex, position;
+            return lot.findCar(record.carId, stackIndex, position);
+        }
+        case TraceOp::Exit:
+            return lot.exitCarFromStackTop(record.carId, record.stackIndex) == LotStatus::Ok;
+        case TraceOp::Sort:
+            return lot.sortStack(record.stackIndex) == LotStatus::Ok;
+        case TraceOp::Move:
+            return lot.moveBetweenStacks(record.stackIndex, record.targetIndex).status == LotStatus::Ok;
+        case TraceOp::MoveTop:
+            return lot.moveTopCar(record.stackIndex, record.targetIndex) == LotStatus::Ok;
+        case TraceOp::Retrieve:
+            return lot.retrieveCar(record.carId).status == LotStatus::Ok;
+    }
+    return false;
+}
+
+// ------------------ TraceWriter ------------------
+
+// Records are collected and written in blocks of about this size
+static const std::size_t WRITE_BLOCK = 1 << 16;
+
+TraceWriter::TraceWriter(const char* path, int numStacks, int stackCapacity)
+    : file(std::fopen(path, "wb")), failed(false) {
+    if (file == nullptr) {
+        failed = true;
+        return;
+    }
+    buffer.reserve(WRITE_BLOCK + 16);
+    buffer.insert(buffer.end(), MAGIC, MAGIC + sizeof(MAGIC));
+    putVarint(buffer, TRACE_VERSION);
+    putVarint(buffer, (std::uint32_t)numStacks);
+    putVarint(buffer, (std::uint32_t)stackCapacity);
+}
+
+TraceWriter::~TraceWriter() {
+    if (file != nullptr) {
+        flush();
+        std::fclose(file);
+    }
+}
+
+bool TraceWriter::ok() const {
+    return !failed;
+}
+
+void TraceWriter::write(const TraceRecord &record) {
+    appendTraceRecord(buffer, record);
+    if (buffer.size() >= WRITE_BLOCK) flush();
+}
+
+bool TraceWriter::flush() {
+    if (file == nullptr) return false;
+    if (!buffer.empty()) {
+        if (std::fwrite(buffer.data(), 1, buffer.size(), file) != buffer.size()) failed = true;
+        buffer.clear();
+    }
+    if (std::fflush(file) != 0) failed = true;
+    return !failed;
+}
+
+// ------------------ TraceReader ------------------
+
+TraceReader::TraceReader(const unsigned char* data, std::size_t size)
+    : cursor(data), end(data + size), numStacks(0), stackCapacity(0), valid(false) {
+    if (size < sizeof(MAGIC) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0) return;
+    cursor += sizeof(MAGIC);
+    int version;
+    if (!getInt(cursor, end, version) || version != TRACE_VERSION) return;
+    if (!getInt(cursor, end, numStacks) || !getInt(cursor, end, stackCapacity)) return;
+    valid = numStacks > 0 && stackCapacity > 0;
+}
+
+bool TraceReader::ok() const {
+    return valid;
+}
+
+int TraceReader::getNumStacks() const {
+    return numStacks;
+}
+
+int TraceReader::getStackCapacity() const {
+    return stackCapacity;
+}
+
+bool TraceReader::next(TraceRecord &record) {
+    if (!valid) return false;
+    return readTraceRecord(cursor, end, record);
+}
+
+bool TraceReader::truncated() const {
+    return valid && cursor != end;
+}
+
+bool TraceReader::unknownOp() const {
+    return truncated() && !isKnownTraceOp(*cursor);
+}
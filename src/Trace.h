@@ -0,0 +1,137 @@
+#ifndef TRACE_H
+#define TRACE_H
+#include "ParkingLot.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+// Compact binary trace of ParkingLot operations, for replaying real
+// workloads offline.
+//
+// File layout (all integers are LEB128 varints; car IDs are zigzag-encoded
+// so negative IDs stay short):
+//   header:  "PLTR" version numStacks stackCapacity
+//   records: op byte followed by that op's arguments
+//     Arrive       carId
+//     ParkFirst    -
+//     ParkSpecific stackIndex
+//     Find         carId
+//     Exit         carId stackIndex
+//     Sort         stackIndex
+//     Move         sourceIndex targetIndex
+//     MoveTop      sourceIndex targetIndex
+//     Retrieve     carId
+// A typical record takes 2-6 bytes.
+//
+// Readers refuse a stream of another version, and stop at an op byte they
+// do not know (see TraceReader::unknownOp) rather than guess at its length.
+
+enum class TraceOp : std::uint8_t {
+    Arrive = 1,     // addCarToEntrance
+    ParkFirst,      // parkCarInFirstAvailableStack
+    ParkSpecific,   // parkCarInSpecificStack
+    Find,           // findCar
+    Exit,           // exitCarFromStackTop
+    Sort,           // sortStack
+    Move,           // moveBetweenStacks
+    MoveTop,        // moveTopCar
+    Retrieve        // retrieveCar
+};
+
+struct TraceRecord {
+    TraceOp op;
+    int carId;        // Arrive, Find, Exit, Retrieve
+    int stackIndex;   // ParkSpecific, Exit, Sort, Move and MoveTop (source)
+    int targetIndex;  // Move, MoveTop
+};
+
+const int TRACE_VERSION = 1;
+
+// Append one encoded record to out.
+// Time Complexity: O(1)
+void appendTraceRecord(std::vector<unsigned char> &out, const TraceRecord &record);
+
+// Decode the record at cursor and advance past it. Returns false (cursor
+// unchanged) if the bytes up to end do not hold a complete, valid record.
+// isKnownTraceOp tells an unknown op apart from a cut-off record.
+// Time Complexity: O(1)
+bool readTraceRecord(const unsigned char* &cursor, const unsigned char* end, TraceRecord &record);
+
+// Time Complexity: O(1)
+bool isKnownTraceOp(unsigned char op);
+
+// Run one record against the lot. Returns true if the operation succeeded
+// (status Ok, or the car was found).
+// Time Complexity: that of the ParkingLot operation
+bool applyTraceRecord(ParkingLot &lot, const TraceRecord &record);
+
+// Buffered trace file writer
+class TraceWriter {
+private:
+    std::FILE* file;
+    std::vector<unsigned char> buffer;
+    bool failed;
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+public:
+    // Creates (truncates) path and writes the header.
+    // Time Complexity: O(1)
+    TraceWriter(const char* path, int numStacks, int stackCapacity);
+
+    // Flushes and closes.
+    // Time Complexity: O(b) for b buffered bytes
+    ~TraceWriter();
+
+    // False if the file could not be opened or a write failed.
+    // Time Complexity: O(1)
+    bool ok() const;
+
+    // Time Complexity: O(1) amortized
+    void write(const TraceRecord &record);
+
+    // Time Complexity: O(b) for b buffered bytes
+    bool flush();
+};
+
+// Decodes a trace held in memory (e.g. a mapped file). Does not copy it.
+class TraceReader {
+private:
+    const unsigned char* cursor;
+    const unsigned char* end;
+    int numStacks;
+    int stackCapacity;
+    bool valid;
+
+public:
+    // Parses the header; check ok() before reading records.
+    // Time Complexity: O(1)
+    TraceReader(const unsigned char* data, std::size_t size);
+
+    // Time Complexity: O(1)
+    bool ok() const;
+
+    // Time Complexity: O(1)
+    int getNumStacks() const;
+
+    // Time Complexity: O(1)
+    int getStackCapacity() const;
+
+    // Next record; false at the end of the trace or at a truncated record.
+    // Time Complexity: O(1)
+    bool next(TraceRecord &record);
+
+    // True once next() has returned false because of leftover bytes
+    // that do not form a record.
+    // Time Complexity: O(1)
+    bool truncated() const;
+
+    // True once next() has returned false at an op byte this build does not
+    // know (a trace from a newer writer, or corruption) rather than at a cut-off record.
+    // Time Complexity: O(1)
+    bool unknownOp() const;
+};
+
+#endif // TRACE_H
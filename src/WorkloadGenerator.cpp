@@ -0,0 +1,215 @@
+#include "WorkloadGenerator.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static const double NEVER = std::numeric_limits<double>::infinity();
+static const double SECONDS_PER_DAY = 24 * 3600;
+
+WorkloadGenerator::WorkloadGenerator(const WorkloadConfig &workload)
+    : config(workload),
+      rng(workload.seed),
+      shadow(workload.numStacks, workload.stackCapacity),
+      now(0),
+      nextCarId(1),
+      queuedCars(0),
+      parkedCars(0),
+      findCredit(0) {
+    if (config.arrivalsPerHour > 0) {
+        baseRate = config.arrivalsPerHour / 3600;
+    } else {
+        // Little's law: occupancy = arrival rate * mean dwell
+        double shape = config.dwellShape > 1.05 ? config.dwellShape : 1.05;
+        double meanDwell = shape * config.minDwellSeconds / (shape - 1);
+        baseRate = 0.6 * config.numStacks * (double)config.stackCapacity / meanDwell;
+    }
+    nextArrival = scheduleArrival(0);
+    nextSort = config.sortsPerHour > 0 ? exponential(config.sortsPerHour / 3600) : NEVER;
+    nextMove = config.movesPerHour > 0 && config.numStacks > 1
+        ? exponential(config.movesPerHour / 3600) : NEVER;
+}
+
+double WorkloadGenerator::uniform() {
+    return std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+}
+
+double WorkloadGenerator::exponential(double ratePerSecond) {
+    return -std::log(1.0 - uniform()) / ratePerSecond;
+}
+
+double WorkloadGenerator::arrivalRate(double time) const {
+    double timeOfDay = std::fmod(time, SECONDS_PER_DAY);
+    for (const RushWindow &w : config.rushWindows) {
+        if (timeOfDay >= w.start && timeOfDay < w.end) return baseRate * config.rushFactor;
+    }
+    return baseRate;
+}
+
+// Non-homogeneous Poisson process by thinning: draw candidates at the peak
+// rate and keep each with probability rate(t) / peak
+double WorkloadGenerator::scheduleArrival(double after) {
+    double peak = config.rushFactor > 1 ? baseRate * config.rushFactor : baseRate;
+    double t = after;
+    do {
+        t += exponential(peak);
+    } while (uniform() * peak > arrivalRate(t));
+    return t;
+}
+
+void WorkloadGenerator::emit(TraceOp op, int carId, int stackIndex, int targetIndex) {
+    ready.push_back(TraceRecord{op, carId, stackIndex, targetIndex});
+}
+
+void WorkloadGenerator::arrive() {
+    if (queuedCars >= config.maxQueuedCars) return;  // queue too long: the driver leaves
+    int carId = nextCarId++;
+    shadow.addCarToEntrance(carId);
+    emit(TraceOp::Arrive, carId, 0, 0);
+    ++queuedCars;
+    parkWaitingCars();
+}
+
+void WorkloadGenerator::parkWaitingCars() {
+    int spaces = config.numStacks * config.stackCapacity;
+    while (queuedCars > 0 && parkedCars < spaces) {
+        ParkResult result;
+        int lane = (int)(rng() % (unsigned)config.numStacks) + 1;
+        if (uniform() < config.parkSpecificFraction && !shadow.getStack(lane).isFull()) {
+            result = shadow.parkCarInSpecificStack(lane);
+            emit(TraceOp::ParkSpecific, 0, lane, 0);
+        } else {
+            result = shadow.parkCarInFirstAvailableStack();
+            emit(TraceOp::ParkFirst, 0, 0, 0);
+        }
+        --queuedCars;
+        ++parkedCars;
+
+        presentSlot[result.carId] = (int)present.size();
+        present.push_back(result.carId);
+        double u = 1.0 - uniform();  // (0, 1]
+        double dwell = config.minDwellSeconds * std::pow(u, -1.0 / config.dwellShape);
+        departures.push(Departure(now + dwell, result.carId));
+    }
+}
+
+void WorkloadGenerator::removePresent(int carId) {
+    auto it = presentSlot.find(carId);
+    int slot = it->second;
+    presentSlot.erase(it);
+    int last = present.back();
+    present.pop_back();
+    if (last != carId) {
+        present[slot] = last;
+        presentSlot[last] = slot;
+    }
+}
+
+void WorkloadGenerator::findSome(int departingCarId) {
+    findCredit += config.findsPerExit;
+    if (findCredit < 1) return;
+    emit(TraceOp::Find, departingCarId, 0, 0);
+    findCredit -= 1;
+    while (findCredit >= 1) {
+        int target;
+        if (present.empty() || uniform() < config.missingFindFraction) {
+            target = nextCarId + (int)(rng() % 1000);  // not issued yet
+        } else {
+            target = present[rng() % present.size()];
+        }
+        emit(TraceOp::Find, target, 0, 0);
+        findCredit -= 1;
+    }
+}
+
+void WorkloadGenerator::exitLeavingTops(int stackIndex) {
+    const Stack &lane = shadow.getStack(stackIndex);
+    int top;
+    while (lane.peek(top)) {
+        auto it = leaving.find(top);
+        if (it == leaving.end()) break;
+        leaving.erase(it);
+        shadow.exitCarFromStackTop(top, stackIndex);
+        emit(TraceOp::Exit, top, stackIndex, 0);
+        removePresent(top);
+        --parkedCars;
+    }
+}
+
+void WorkloadGenerator::moveStacks(int source, int target) {
+    // The moved cars are the source's top ones; note them before they go
+    std::vector<int> sourceCars;
+    for (const Car* c = shadow.getStack(source).topCar(); c != nullptr; c = c->next) {
+        sourceCars.push_back(c->carId);
+    }
+    MoveResult result = shadow.moveBetweenStacks(source, target);
+    emit(TraceOp::Move, 0, source, target);
+
+    // Cars now on top anywhere the move reached (the target, lanes it
+    // spilled into, and the source if some cars stayed) may be overdue
+    std::vector<int> touched(1, source);
+    for (int i = 0; i < result.carsMoved; ++i) {
+        int stackIndex, position;
+        shadow.findCar(sourceCars[i], stackIndex, position);
+        if (std::find(touched.begin(), touched.end(), stackIndex) == touched.end()) {
+            touched.push_back(stackIndex);
+        }
+    }
+    for (int stackIndex : touched) exitLeavingTops(stackIndex);
+}
+
+void WorkloadGenerator::depart(int carId) {
+    findSome(carId);
+    int stackIndex, position;
+    shadow.findCar(carId, stackIndex, position);
+    leaving.insert(carId);
+    if (position == 1) {
+        exitLeavingTops(stackIndex);  // this car, then any waiting right below it
+        parkWaitingCars();
+    }
+}
+
+TraceRecord WorkloadGenerator::next() {
+    while (ready.empty()) {
+        double departure = departures.empty() ? NEVER : departures.top().first;
+        double t = std::fmin(std::fmin(nextArrival, departure), std::fmin(nextSort, nextMove));
+        now = t;
+
+        if (t == departure) {
+            int carId = departures.top().second;
+            departures.pop();
+            depart(carId);
+        } else if (t == nextArrival) {
+            arrive();
+            nextArrival = scheduleArrival(now);
+        } else if (t == nextSort) {
+            int lane = (int)(rng() % (unsigned)config.numStacks) + 1;
+            shadow.sortStack(lane);
+            emit(TraceOp::Sort, 0, lane, 0);
+            exitLeavingTops(lane);
+            parkWaitingCars();
+            nextSort = now + exponential(config.sortsPerHour / 3600);
+        } else {
+            int source = (int)(rng() % (unsigned)config.numStacks) + 1;
+            int target = (int)(rng() % (unsigned)(config.numStacks - 1)) + 1;
+            if (target >= source) ++target;  // any stack but the source
+            moveStacks(source, target);
+            parkWaitingCars();
+            nextMove = now + exponential(config.movesPerHour / 3600);
+        }
+    }
+    TraceRecord record = ready.front();
+    ready.pop_front();
+    return record;
+}
+
+double WorkloadGenerator::clock() const {
+    return now;
+}
+
+int WorkloadGenerator::getNumStacks() const {
+    return config.numStacks;
+}
+
+int WorkloadGenerator::getStackCapacity() const {
+    return config.stackCapacity;
+}
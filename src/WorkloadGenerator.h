@@ -0,0 +1,115 @@
+#ifndef WORKLOADGENERATOR_H
+#define WORKLOADGENERATOR_H
+#include "ParkingLot.h"
+#include "Trace.h"
+#include <deque>
+#include <functional>
+#include <queue>
+#include <random>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+// Period of higher arrival rate, in seconds since midnight
+struct RushWindow {
+    double start;
+    double end;
+};
+
+struct WorkloadConfig {
+    unsigned seed = 1;
+    int numStacks = 1000;
+    int stackCapacity = 100;
+
+    // Off-peak Poisson arrival rate. 0 = sized to keep the lot about 60%
+    // full off-peak, given the mean dwell time.
+    double arrivalsPerHour = 0;
+    double rushFactor = 3.0;  // arrival rate multiplier inside rush windows
+    int maxQueuedCars = 50;   // arrivals that find this many cars waiting drive away
+    std::vector<RushWindow> rushWindows = {{7.5 * 3600, 9.5 * 3600}, {16.5 * 3600, 18.5 * 3600}};
+
+    // Dwell time is Pareto distributed: at least minDwellSeconds, with a tail
+    // that gets heavier as dwellShape approaches 1 (mean is infinite at 1)
+    double minDwellSeconds = 600;
+    double dwellShape = 1.5;
+
+    double findsPerExit = 2.0;          // the first find of each departure is for the leaving car
+    double missingFindFraction = 0.05;  // other finds that ask for a car not in the lot
+    double parkSpecificFraction = 0.1;  // arrivals that choose their own (non-full) stack
+    double sortsPerHour = 2;
+    double movesPerHour = 2;
+};
+
+// Seeded, endless stream of realistic ParkingLot operations.
+//
+// Simulated time advances event by event: arrivals (Poisson, faster in rush
+// windows) enter and park, and each parked car schedules its departure after
+// a heavy-tailed dwell. A departing car that is not on top of its stack waits
+// until the cars above it have left, then exits right after them. Cars that
+// arrive while the lot is full wait in the entrance queue, up to
+// maxQueuedCars; later ones drive away and produce no operation.
+//
+// Every operation is applied to a private (silent) shadow lot first, so the
+// stream is valid for a fresh ParkingLot of the same shape: exits name the
+// car on top, and parks never hit a full stack. Feed the records to a lot
+// with applyTraceRecord or write them with TraceWriter.
+class WorkloadGenerator {
+private:
+    typedef std::pair<double, int> Departure;  // (time, carId)
+
+    WorkloadConfig config;
+    std::mt19937_64 rng;
+    ParkingLot shadow;
+
+    double now;             // simulated seconds since midnight of day 0
+    double baseRate;        // arrivals per second off-peak
+    double nextArrival;
+    double nextSort;
+    double nextMove;
+    int nextCarId;
+    int queuedCars;         // waiting at the entrance
+    int parkedCars;
+    double findCredit;
+
+    std::priority_queue<Departure, std::vector<Departure>, std::greater<Departure>> departures;
+    std::unordered_set<int> leaving;          // dwell over, blocked by cars above
+    std::vector<int> present;                 // parked cars, for random find targets
+    std::unordered_map<int, int> presentSlot; // carId -> index in present
+    std::deque<TraceRecord> ready;            // generated, not yet handed out
+
+    double uniform();
+    double exponential(double ratePerSecond);
+    double arrivalRate(double time) const;
+    double scheduleArrival(double after);
+
+    void emit(TraceOp op, int carId, int stackIndex, int targetIndex);
+    void arrive();
+    void parkWaitingCars();
+    void depart(int carId);
+    void exitLeavingTops(int stackIndex);
+    void moveStacks(int source, int target);
+    void findSome(int departingCarId);
+    void removePresent(int carId);
+
+public:
+    // Time Complexity: O(n * m) for the shadow lot
+    explicit WorkloadGenerator(const WorkloadConfig &workload);
+
+    // Next operation of the stream.
+    // Time Complexity: O(log d) amortized for d scheduled departures
+    // (sorts and moves cost what they cost on the lot)
+    TraceRecord next();
+
+    // Simulated seconds elapsed so far.
+    // Time Complexity: O(1)
+    double clock() const;
+
+    // Time Complexity: O(1)
+    int getNumStacks() const;
+
+    // Time Complexity: O(1)
+    int getStackCapacity() const;
+};
+
+#endif // WORKLOADGENERATOR_H
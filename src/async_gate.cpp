@@ -0,0 +1,134 @@
+// Drives AsyncParkingLot with one coroutine session per arriving car and
+// checks every session's outcome: each car parks, finds itself in the stack
+// it was parked in, and a repeated ID is refused. The lot is smaller than the
+// number of sessions, so parks regularly wait for space (pending parks) and
+// are served once departures empty the lot. Also times the same arrivals
+// through the synchronous ParkingLot calls for comparison.
+//
+// Build (from src/; coroutines need C++20):
+//   g++ -std=c++20 -O2 -pthread -o async_gate async_gate.cpp AsyncParkingLot.cpp CarIndex.cpp
+//       CarPool.cpp FreeLaneSet.cpp Journal.cpp LotEvent.cpp MpmcQueue.cpp ParkingLot.cpp Queue.cpp
+//       RingQueue.cpp Stack.cpp ThreadPool.cpp Trace.cpp
+// Usage:
+//   async_gate [sessions stacks capacity]     (default 100000 sessions, 100x100 lot)
+// Exits with status 1 if any session ends differently than expected.
+
+#include "AsyncParkingLot.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+struct Tally {
+    long parked = 0;
+    long duplicates = 0;
+    long found = 0;
+    long wrong = 0;     // unexpected status, or found somewhere else
+    long finished = 0;
+};
+
+AsyncParkingLot::Session gateSession(AsyncParkingLot &gates, int carId, Tally &tally) {
+    ParkResult parked = co_await gates.park(carId);
+    if (parked.status == LotStatus::Ok) {
+        ++tally.parked;
+        FindResult where = co_await gates.find(carId);
+        if (where.found && where.stackIndex == parked.stackIndex) {
+            ++tally.found;
+        } else {
+            ++tally.wrong;
+        }
+    } else if (parked.status == LotStatus::DuplicateCar) {
+        ++tally.duplicates;
+    } else {
+        ++tally.wrong;
+    }
+    ++tally.finished;
+}
+
+// Every car leaves, top first. Returns the number of cars that left.
+long emptyLot(ParkingLot &lot) {
+    long left = 0;
+    for (int lane = 1; lane <= lot.getNumStacks(); ++lane) {
+        int top;
+        while (lot.getStack(lane).peek(top)) {
+            lot.exitCarFromStackTop(top, lane);
+            ++left;
+        }
+    }
+    return left;
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    int sessions = 100000;
+    int stacks = 100;
+    int capacity = 100;
+    if (argc == 4) {
+        sessions = std::atoi(argv[1]);
+        stacks = std::atoi(argv[2]);
+        capacity = std::atoi(argv[3]);
+    }
+    if ((argc != 1 && argc != 4) || sessions <= 0 || stacks <= 0 || capacity <= 0) {
+        std::fprintf(stderr, "usage: %s [sessions stacks capacity]\n", argv[0]);
+        return 2;
+    }
+
+    // ** Coroutine sessions, served in ticks **
+    Tally tally;
+    long emptied = 0;
+    double asyncSeconds;
+    {
+        ParkingLot lot(stacks, capacity);
+        AsyncParkingLot gates(lot);
+        auto start = std::chrono::steady_clock::now();
+        for (int carId = 1; carId <= sessions; ++carId) gateSession(gates, carId, tally);
+        gateSession(gates, 1, tally);  // same ID in the same tick: refused
+        gates.runUntilIdle();
+        while (gates.pending() > 0) {
+            // Only parks waiting for space are left; make room for them
+            emptyLot(lot);
+            ++emptied;
+            gates.runUntilIdle();
+        }
+        asyncSeconds = secondsSince(start);
+    }
+
+    // ** The same arrivals, one synchronous call at a time **
+    double syncSeconds;
+    {
+        ParkingLot lot(stacks, capacity);
+        const long spaces = (long)stacks * capacity;
+        long parked = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int carId = 1; carId <= sessions; ++carId) {
+            if (parked == spaces) parked -= emptyLot(lot);
+            lot.addCarToEntrance(carId);
+            parked += lot.parkCarInFirstAvailableStack().status == LotStatus::Ok;
+            int stackIndex, position;
+            lot.findCar(carId, stackIndex, position);
+        }
+        syncSeconds = secondsSince(start);
+    }
+
+    std::printf("%d sessions on a %dx%d lot, lot emptied %ld times for pending parks\n", sessions,
+                stacks, capacity, emptied);
+    std::printf("parked %ld, found in their stack %ld, duplicates refused %ld, wrong %ld\n",
+                tally.parked, tally.found, tally.duplicates, tally.wrong);
+    std::printf("%12s %12s\n", "", "ns/car");
+    std::printf("%12s %12.1f\n", "sessions", asyncSeconds * 1e9 / sessions);
+    std::printf("%12s %12.1f\n", "sync calls", syncSeconds * 1e9 / sessions);
+
+    bool ok = tally.parked == sessions && tally.found == sessions && tally.duplicates == 1 &&
+              tally.wrong == 0 && tally.finished == (long)sessions + 1;
+    if (!ok) {
+        std::printf("ERROR: sessions did not all end as expected\n");
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,635 @@
+// Benchmarks for the parking lot data structures.
+//
+// Build (from src/), linking every engine .cpp except gui_fltk.cpp:
+//   g++ -std=c++17 -O2 -pthread -o benchmark benchmark.cpp CarIndex.cpp CarPool.cpp FreeLaneSet.cpp
+//       Journal.cpp LotEvent.cpp MpmcQueue.cpp ParkingLot.cpp Queue.cpp RingQueue.cpp Stack.cpp
+//       ThreadPool.cpp Trace.cpp WorkloadGenerator.cpp
+// Usage:
+//   benchmark [ops|workload|journal|sort|sortall|find|queue|gate]
+// Workloads use fixed seeds, so runs are comparable across changes.
+// "ops" times each public ParkingLot operation across lot sizes and prints
+// ns/op plus allocations/op: heap = global operator new calls, pool = Car
+// nodes handed out by CarPool.
+
+#include "CarPool.h"
+#include "Journal.h"
+#include "MpmcQueue.h"
+#include "ParkingLot.h"
+#include "Queue.h"
+#include "RingQueue.h"
+#include "Stack.h"
+#include "WorkloadGenerator.h"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+// ------------------ allocation counting ------------------
+
+static std::atomic<std::size_t> heapAllocations(0);
+
+// GCC pairs the inlined malloc with the library operator new and warns
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void* operator new(std::size_t size) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* p = std::malloc(size ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ------------------ Reference: the original recursive merge sort ------------------
+
+void recursiveSplit(Car* source, Car** frontRef, Car** backRef) {
+    Car* slow = source;
+    Car* fast = source->next;
+    while (fast != nullptr) {
+        fast = fast->next;
+        if (fast != nullptr) {
+            slow = slow->next;
+            fast = fast->next;
+        }
+    }
+    *frontRef = source;
+    *backRef = slow->next;
+    slow->next = nullptr;
+}
+
+Car* recursiveMerge(Car* a, Car* b) {
+    if (!a) return b;
+    if (!b) return a;
+    Car* result;
+    if (a->carId <= b->carId) {
+        result = a;
+        result->next = recursiveMerge(a->next, b);
+    } else {
+        result = b;
+        result->next = recursiveMerge(a, b->next);
+    }
+    return result;
+}
+
+Car* recursiveMergeSort(Car* head) {
+    if (head == nullptr || head->next == nullptr) return head;
+    Car* a;
+    Car* b;
+    recursiveSplit(head, &a, &b);
+    return recursiveMerge(recursiveMergeSort(a), recursiveMergeSort(b));
+}
+
+// ------------------ sort ------------------
+
+std::vector<int> randomIds(int count, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::vector<int> ids(count);
+    for (int i = 0; i < count; ++i) ids[i] = (int)(rng() & 0x7fffffff);
+    return ids;
+}
+
+bool ascendingFromTop(const Car* c) {
+    for (; c != nullptr && c->next != nullptr; c = c->next) {
+        if (c->carId > c->next->carId) return false;
+    }
+    return true;
+}
+
+void benchSort() {
+    std::printf("== Stack::sort vs original recursive merge sort ==\n");
+    std::printf("(Stack::sort uses merge sort below %d cars, radix sort from there up)\n",
+                Stack::RADIX_THRESHOLD);
+    std::printf("%10s %8s %8s %14s %14s\n", "cars", "lanes", "path", "Stack us", "recursive us");
+
+    // The recursive merge recurses once per node, so large lanes overflow the
+    // default thread stack; it is only run where it is known to survive.
+    const int RECURSIVE_LIMIT = 50000;
+    // Short lanes take the merge-sort path; they are sorted many at a time
+    // and timed per lane
+    const int sizes[] = {8, 16, 32, 48, 64, 1000, 10000, 50000, 300000, 1000000};
+    const int SHORT_LANE_CARS = 200000;
+
+    for (int n : sizes) {
+        int count = n < 1000 ? SHORT_LANE_CARS / n : 1;
+        std::vector<int> ids = randomIds(n * count, 42);
+
+        std::vector<Stack*> lanes(count);
+        for (int l = 0; l < count; ++l) {
+            lanes[l] = new Stack(n);
+            for (int i = 0; i < n; ++i) lanes[l]->push(ids[l * n + i]);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (Stack* lane : lanes) lane->sort();
+        double stackUs = secondsSince(start) * 1e6 / count;
+        for (Stack* lane : lanes) {
+            if (!ascendingFromTop(lane->topCar())) {
+                std::printf("ERROR: Stack::sort produced a wrong order for %d cars\n", n);
+                std::exit(1);
+            }
+            delete lane;
+        }
+        const char* path = n < Stack::RADIX_THRESHOLD ? "merge" : "radix";
+
+        if (n > RECURSIVE_LIMIT) {
+            std::printf("%10d %8d %8s %14.2f %14s\n", n, count, path, stackUs, "(stack overflow)");
+            continue;
+        }
+
+        std::vector<Car*> heads(count, nullptr);
+        for (int l = 0; l < count; ++l) {
+            for (int i = 0; i < n; ++i) {
+                Car* c = new Car(ids[l * n + i]);
+                c->next = heads[l];
+                heads[l] = c;
+            }
+        }
+        start = std::chrono::steady_clock::now();
+        for (Car* &head : heads) head = recursiveMergeSort(head);
+        double recUs = secondsSince(start) * 1e6 / count;
+        for (Car* head : heads) {
+            while (head != nullptr) {
+                Car* next = head->next;
+                delete head;
+                head = next;
+            }
+        }
+        std::printf("%10d %8d %8s %14.2f %14.2f\n", n, count, path, stackUs, recUs);
+    }
+}
+
+// ------------------ lot helpers ------------------
+
+// Park `cars` distinct random IDs, filling lanes in order
+void fillLot(ParkingLot &lot, int cars, unsigned seed) {
+    std::vector<int> ids = randomIds(cars, seed);
+    const int BURST = 4096;
+    for (int i = 0; i < cars; i += BURST) {
+        int n = cars - i < BURST ? cars - i : BURST;
+        lot.addCarsToEntrance(ids.data() + i, n);
+        lot.parkBatch(n);
+    }
+}
+
+// ------------------ per-operation costs ------------------
+
+// Distinct IDs in scrambled order: i * odd constant is a bijection mod 2^31
+std::vector<int> distinctIds(int count, int offset) {
+    std::vector<int> ids(count);
+    for (int i = 0; i < count; ++i) {
+        ids[i] = (int)(((unsigned)(i + offset) * 2654435761u) & 0x7fffffff);
+    }
+    return ids;
+}
+
+// Times one operation over `ops` calls and prints one table row
+class OpTimer {
+private:
+    const char* name;
+    long ops;
+    std::size_t heapStart;
+    std::size_t poolStart;
+    std::chrono::steady_clock::time_point start;
+
+public:
+    OpTimer(const char* opName, long opCount)
+        : name(opName), ops(opCount),
+          heapStart(heapAllocations.load()),
+          poolStart(CarPool::totalAllocations()),
+          start(std::chrono::steady_clock::now()) {}
+
+    ~OpTimer() {
+        double ns = secondsSince(start) * 1e9;
+        double heap = (double)(heapAllocations.load() - heapStart);
+        double pool = (double)(CarPool::totalAllocations() - poolStart);
+        if (ops <= 0) ops = 1;
+        std::printf("%16s %10ld %12.1f %10.3f %10.3f\n", name, ops, ns / ops, heap / ops, pool / ops);
+    }
+};
+
+// Each shape is filled to 3/4: the first half of the lanes full through
+// parkCarInFirstAvailableStack, the second half half-full through
+// parkCarInSpecificStack. Exits then empty the top half of the full lanes,
+// whose top cars are known from the park order.
+void benchOps() {
+    std::printf("== ParkingLot operations (ns/op, allocations/op) ==\n");
+    const int shapes[][2] = {{10, 10}, {100, 100}, {1000, 100}, {1000, 1000}, {10000, 1000}};
+    for (const auto &shape : shapes) {
+        int lanes = shape[0];
+        int capacity = shape[1];
+        int fullLanes = lanes / 2;
+        int firstCars = fullLanes * capacity;
+        int specificCars = (lanes - fullLanes) * (capacity / 2);
+
+        std::printf("-- %dx%d --\n", lanes, capacity);
+        std::printf("%16s %10s %12s %10s %10s\n", "operation", "ops", "ns/op", "heap/op", "pool/op");
+
+        ParkingLot lot(lanes, capacity);
+        std::vector<int> firstIds = distinctIds(firstCars, 0);
+        std::vector<int> specificIds = distinctIds(specificCars, firstCars);
+
+        {
+            OpTimer t("addCar", firstCars);
+            for (int id : firstIds) lot.addCarToEntrance(id);
+        }
+        {
+            OpTimer t("parkFirst", firstCars);
+            for (int i = 0; i < firstCars; ++i) lot.parkCarInFirstAvailableStack();
+        }
+        for (int id : specificIds) lot.addCarToEntrance(id);
+        {
+            OpTimer t("parkSpecific", specificCars);
+            for (int i = 0; i < specificCars; ++i) {
+                lot.parkCarInSpecificStack(fullLanes + i % (lanes - fullLanes) + 1);
+            }
+        }
+
+        const int LOOKUPS = 1000000;
+        std::mt19937 rng(3);
+        std::vector<int> targets(LOOKUPS);
+        for (int &id : targets) {
+            id = rng() % 2 ? firstIds[rng() % firstCars] : specificIds[rng() % specificCars];
+        }
+        long found = 0;
+        {
+            OpTimer t("findCar", LOOKUPS);
+            int s, p;
+            for (int id : targets) found += lot.findCar(id, s, p);
+        }
+        if (found != LOOKUPS) {
+            std::printf("ERROR: findCar missed %ld parked cars\n", LOOKUPS - found);
+            std::exit(1);
+        }
+
+        // Lane L was filled with firstIds[L*capacity ...], so its top is the last of those
+        int exits = fullLanes * (capacity / 2);
+        {
+            OpTimer t("exitCar", exits);
+            for (int lane = 0; lane < fullLanes; ++lane) {
+                for (int k = 0; k < capacity / 2; ++k) {
+                    int top = firstIds[lane * capacity + capacity - 1 - k];
+                    if (lot.exitCarFromStackTop(top, lane + 1) != LotStatus::Ok) {
+                        std::printf("ERROR: car %d was not on top of stack %d\n", top, lane + 1);
+                        std::exit(1);
+                    }
+                }
+            }
+        }
+        {
+            OpTimer t("sortStack", lanes);
+            for (int lane = 1; lane <= lanes; ++lane) lot.sortStack(lane);
+        }
+
+        // Each move empties a random non-empty lane into a different one
+        // (spilling over when the target fills); lanes emptied by earlier
+        // moves are not picked as sources, so every call moves cars.
+        int moves = lanes < 1000 ? lanes : 1000;
+        long carsMoved = 0;
+        {
+            OpTimer t("moveStacks", moves);
+            for (int i = 0; i < moves; ++i) {
+                int source, target;
+                do {
+                    source = rng() % lanes + 1;
+                } while (lot.getStack(source).isEmpty());
+                do {
+                    target = rng() % lanes + 1;
+                } while (target == source);
+                carsMoved += lot.moveBetweenStacks(source, target).carsMoved;
+            }
+        }
+        std::printf("%16s %10s %12.1f cars/move\n", "", "", (double)carsMoved / moves);
+    }
+}
+
+// ------------------ realistic mixes ------------------
+
+// Replays WorkloadGenerator streams (generated up front, untimed) on fresh lots
+void benchWorkload() {
+    std::printf("== Generated traffic mixes (WorkloadGenerator, seed 1) ==\n");
+    std::printf("%16s %10s %8s %12s %10s\n", "lot", "ops", "hours", "ns/op", "ok");
+
+    const int OPS = 2000000;
+    const int shapes[][2] = {{100, 100}, {1000, 100}, {1000, 1000}};
+    for (const auto &shape : shapes) {
+        WorkloadConfig config;
+        config.numStacks = shape[0];
+        config.stackCapacity = shape[1];
+        WorkloadGenerator generator(config);
+        std::vector<TraceRecord> records(OPS);
+        for (TraceRecord &r : records) r = generator.next();
+
+        ParkingLot lot(shape[0], shape[1]);
+        long ok = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const TraceRecord &r : records) ok += applyTraceRecord(lot, r);
+        double ns = secondsSince(start) * 1e9 / OPS;
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%d", shape[0], shape[1]);
+        std::printf("%16s %10d %8.1f %12.1f %9.1f%%\n", label, OPS, generator.clock() / 3600, ns,
+                    100.0 * ok / OPS);
+    }
+}
+
+// ------------------ journaling overhead ------------------
+
+// Replays one generated mix with and without a write-ahead journal. The
+// fsync-per-operation row shows what group commit saves.
+void benchJournal() {
+    std::printf("== Write-ahead journal overhead (1000x100 generated mix) ==\n");
+    std::printf("%28s %10s %12s %12s\n", "journal", "ops", "ns/op", "+ns/op");
+
+    const int OPS = 2000000;
+    WorkloadConfig config;
+    config.numStacks = 1000;
+    config.stackCapacity = 100;
+    WorkloadGenerator generator(config);
+    std::vector<TraceRecord> records(OPS);
+    for (TraceRecord &r : records) r = generator.next();
+
+    struct Setting {
+        const char* name;
+        int groupCommitMillis;
+        int groupCommitRecords;
+        int ops;
+    };
+    const Setting settings[] = {
+        {"off", 0, 0, OPS},
+        {"sync() only at the end", 0, 0, OPS},
+        {"commit every 10 ms", 10, 0, OPS},
+        {"commit every 256 records", 0, 256, OPS},
+        {"fsync every operation", 0, 1, 20000},
+    };
+    const char* path = "benchmark.journal";
+    double baseNs = 0;
+    for (const Setting &setting : settings) {
+        std::remove(path);
+        ParkingLot lot(config.numStacks, config.stackCapacity);
+        JournalConfig journalConfig;
+        journalConfig.groupCommitMillis = setting.groupCommitMillis;
+        journalConfig.groupCommitRecords = setting.groupCommitRecords;
+        bool journaled = &setting != &settings[0];
+        Journal* journal = journaled ? new Journal(path, config.numStacks, config.stackCapacity, journalConfig) : nullptr;
+        lot.setJournal(journal);
+
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < setting.ops; ++i) applyTraceRecord(lot, records[i]);
+        if (journal) journal->sync();
+        double ns = secondsSince(start) * 1e9 / setting.ops;
+        if (!journaled) baseNs = ns;
+
+        if (journal && !journal->ok()) {
+            std::printf("ERROR: journal write failed\n");
+            std::exit(1);
+        }
+        lot.setJournal(nullptr);
+        delete journal;
+        std::printf("%28s %10d %12.1f %12.1f\n", setting.name, setting.ops, ns, ns - baseNs);
+    }
+    std::remove(path);
+}
+
+// ------------------ sortAllStacks ------------------
+
+void benchSortAll() {
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("== ParkingLot::sortAllStacks, serial vs thread pool (%u cores) ==\n", cores);
+    std::printf("%16s %12s %12s %9s\n", "lot", "serial ms", "pool ms", "speedup");
+
+    const int shapes[][2] = {{100, 1000}, {1000, 1000}, {10000, 100}};
+    for (const auto &shape : shapes) {
+        int lanes = shape[0];
+        int capacity = shape[1];
+
+        ParkingLot serialLot(lanes, capacity);
+        ParkingLot poolLot(lanes, capacity);
+        fillLot(serialLot, lanes * capacity, 7);
+        fillLot(poolLot, lanes * capacity, 7);
+
+        auto start = std::chrono::steady_clock::now();
+        serialLot.sortAllStacks(1);
+        double serialMs = secondsSince(start) * 1e3;
+
+        start = std::chrono::steady_clock::now();
+        poolLot.sortAllStacks(0);  // includes starting the pool's threads
+        double poolMs = secondsSince(start) * 1e3;
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%d", lanes, capacity);
+        std::printf("%16s %12.2f %12.2f %8.2fx\n", label, serialMs, poolMs, serialMs / poolMs);
+    }
+}
+
+// ------------------ findCar: index vs serial scan vs parallel scan ------------------
+
+void benchFind() {
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("== findCar (index) vs findCarByScan serial / parallel (%u cores) ==\n", cores);
+    std::printf("%16s %12s %14s %14s\n", "lot", "index ns", "scan us", "par scan us");
+
+    const int shapes[][2] = {{1000, 100}, {1000, 1000}, {10000, 100}};
+    for (const auto &shape : shapes) {
+        int lanes = shape[0];
+        int capacity = shape[1];
+        int cars = lanes * capacity;
+        ParkingLot lot(lanes, capacity);
+        fillLot(lot, cars, 11);
+
+        // Look up parked cars at random depths/lanes, same order for every mode
+        std::vector<int> ids = randomIds(cars, 11);
+        std::mt19937 rng(5);
+        const int LOOKUPS = 200;
+        std::vector<int> targets(LOOKUPS);
+        for (int &t : targets) t = ids[rng() % cars];
+
+        int s, p;
+        long found = 0;
+        const int INDEX_REPEAT = 1000;
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < INDEX_REPEAT; ++r) {
+            for (int id : targets) found += lot.findCar(id, s, p);
+        }
+        double indexNs = secondsSince(start) * 1e9 / (LOOKUPS * INDEX_REPEAT);
+
+        start = std::chrono::steady_clock::now();
+        for (int id : targets) found += lot.findCarByScan(id, s, p, 1);
+        double scanUs = secondsSince(start) * 1e6 / LOOKUPS;
+
+        lot.findCarByScan(targets[0], s, p, 0);  // start the pool outside the timing
+        start = std::chrono::steady_clock::now();
+        for (int id : targets) found += lot.findCarByScan(id, s, p, 0);
+        double parUs = secondsSince(start) * 1e6 / LOOKUPS;
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "%dx%d", lanes, capacity);
+        std::printf("%16s %12.1f %14.1f %14.1f   (found %ld)\n", label, indexNs, scanUs, parUs, found);
+    }
+}
+
+// ------------------ entrance queue: lock-free vs mutex ------------------
+
+// The linked Queue behind one mutex, as a gate-shared entrance would be today
+class LockedQueue {
+private:
+    Queue queue;
+    std::mutex lock;
+
+public:
+    bool enqueue(int carId) {
+        std::lock_guard<std::mutex> guard(lock);
+        queue.enqueue(carId);
+        return true;
+    }
+    bool dequeue(int &carId) {
+        std::lock_guard<std::mutex> guard(lock);
+        return queue.dequeue(carId);
+    }
+};
+
+// `producers` gates each enqueue `perProducer` IDs while `consumers` workers
+// drain the queue. Delivery order and exactly-once are checked by
+// lot_check queue, not here. Returns millions of cars through the queue per second.
+template <class Q>
+double runQueue(Q &queue, int producers, int consumers, int perProducer) {
+    const int total = producers * perProducer;
+    std::atomic<int> consumed(0);
+    std::vector<std::thread> threads;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, perProducer] {
+            for (int i = 0; i < perProducer; ++i) {
+                while (!queue.enqueue(i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (int c = 0; c < consumers; ++c) {
+        threads.emplace_back([&queue, &consumed, total] {
+            int carId;
+            while (consumed.load(std::memory_order_relaxed) < total) {
+                if (queue.dequeue(carId)) {
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (std::thread &t : threads) t.join();
+    return total / secondsSince(start) / 1e6;
+}
+
+void benchQueue() {
+    unsigned cores = std::thread::hardware_concurrency();
+    std::printf("== Entrance queue: MpmcQueue vs mutex + Queue (%u cores) ==\n", cores);
+    std::printf("%8s %10s %14s %14s\n", "gates", "workers", "lock-free M/s", "mutex M/s");
+
+    const int PER_PRODUCER = 200000;
+    const int shapes[][2] = {{1, 1}, {2, 2}, {4, 2}, {8, 4}};
+    for (const auto &shape : shapes) {
+        MpmcQueue lockFree(1 << 14);
+        LockedQueue locked;
+        double lockFreeRate = runQueue(lockFree, shape[0], shape[1], PER_PRODUCER);
+        double lockedRate = runQueue(locked, shape[0], shape[1], PER_PRODUCER);
+        std::printf("%8d %10d %14.2f %14.2f\n", shape[0], shape[1], lockFreeRate, lockedRate);
+    }
+}
+
+// ------------------ gate in front of the lot ------------------
+
+// Cars wait at a bounded gate until the parking loop admits and parks them.
+// Linked Queue gate, one car per call, against a RingQueue gate drained with
+// admitFromGate + parkBatch. The ring gate refuses cars while full, so
+// arrivals stop there instead of growing the gate.
+void benchGate() {
+    std::printf("== Gate -> lot: linked Queue per car vs RingQueue batches ==\n");
+    std::printf("%16s %8s %14s %14s %10s\n", "lot", "batch", "Queue ns/car", "Ring ns/car", "refused");
+
+    const int GATE_LIMIT = 4096;
+    const int shapes[][2] = {{100, 100}, {1000, 1000}};
+    const int batches[] = {16, 256};
+    for (const auto &shape : shapes) {
+        const int cars = shape[0] * shape[1];
+        for (int batch : batches) {
+            double queueNs;
+            {
+                ParkingLot lot(shape[0], shape[1]);
+                Queue gate;
+                auto start = std::chrono::steady_clock::now();
+                for (int next = 1; next <= cars; ) {
+                    for (int i = 0; i < batch && next <= cars; ++i) gate.enqueue(next++);
+                    int carId;
+                    while (gate.dequeue(carId)) {
+                        lot.addCarToEntrance(carId);
+                        lot.parkCarInFirstAvailableStack();
+                    }
+                }
+                queueNs = secondsSince(start) * 1e9 / cars;
+            }
+
+            double ringNs;
+            long refused = 0;
+            {
+                ParkingLot lot(shape[0], shape[1]);
+                RingQueue gate(GATE_LIMIT);
+                int parked = 0;
+                auto start = std::chrono::steady_clock::now();
+                for (int next = 1; parked < cars; ) {
+                    // A burst of arrivals; the last ones bounce while the gate is full
+                    for (int i = 0; i < 2 * batch && next <= cars; ++i) {
+                        if (gate.enqueue(next)) {
+                            ++next;
+                        } else {
+                            ++refused;
+                            break;
+                        }
+                    }
+                    lot.admitFromGate(gate, batch);
+                    parked += (int)lot.parkBatch(batch).size();
+                }
+                ringNs = secondsSince(start) * 1e9 / cars;
+            }
+
+            char label[32];
+            std::snprintf(label, sizeof(label), "%dx%d", shape[0], shape[1]);
+            std::printf("%16s %8d %14.1f %14.1f %10ld\n", label, batch, queueNs, ringNs, refused);
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* which = argc > 1 ? argv[1] : "all";
+    bool all = std::strcmp(which, "all") == 0;
+
+    if (all || std::strcmp(which, "ops") == 0) benchOps();
+    if (all || std::strcmp(which, "workload") == 0) benchWorkload();
+    if (all || std::strcmp(which, "journal") == 0) benchJournal();
+    if (all || std::strcmp(which, "sort") == 0) benchSort();
+    if (all || std::strcmp(which, "sortall") == 0) benchSortAll();
+    if (all || std::strcmp(which, "find") == 0) benchFind();
+    if (all || std::strcmp(which, "queue") == 0) benchQueue();
+    if (all || std::strcmp(which, "gate") == 0) benchGate();
+    return 0;
+}
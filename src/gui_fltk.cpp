@@ -1,3 +1,12 @@
+// Operator console for the parking lot. Every button drives a ParkingLot and
+// the view draws what it reads back, so the console shows the engine's real
+// behavior and costs.
+//
+// Build (from src/):
+//   g++ -std=c++17 -O2 -pthread -o parking_gui gui_fltk.cpp CarIndex.cpp CarPool.cpp
+//       FreeLaneSet.cpp Journal.cpp LotEvent.cpp MpmcQueue.cpp ParkingLot.cpp Queue.cpp RingQueue.cpp
+//       Stack.cpp ThreadPool.cpp Trace.cpp WorkloadGenerator.cpp $(fltk-config --cxxflags --ldflags)
+
 #include <FL/Fl.H>
 #include <FL/Fl_Window.H>
 #include <FL/Fl_Button.H>
@@ -7,20 +16,28 @@
 #include <FL/Fl_Scroll.H>
 #include <FL/fl_draw.H>
 
-#include <vector>
+#include "ParkingLot.h"
+#include "WorkloadGenerator.h"
+
 #include <string>
+#include <vector>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 // ------------------ Global state (like React useState) ------------------
 
-static int g_numStacks = 3;
-static int g_stackCapacity = 5;
-static bool g_initialized = false;
-
-static std::vector<std::vector<int>> g_stacks;       // stacks[i], top at index 0
-static std::vector<int> g_entranceQueue;             // front at index 0
+// The engine holds all lot state; the GUI keeps no copy of it
+static ParkingLot* g_lot = nullptr;  // nullptr until initialized
 static int g_nextCarId = 1;
 
 // inputs
@@ -33,31 +50,164 @@ static Fl_Input* g_moveCarIdInput   = nullptr;  // Move car
 static Fl_Input* g_targetStackInput = nullptr;  // Move target stack
 static Fl_Input* g_exitCarIdInput   = nullptr;  // Exit by car ID
 static Fl_Input* g_sortStackInput   = nullptr;
+static Fl_Input* g_rateInput        = nullptr;  // Simulation ops/sec
+static Fl_Box*   g_simStatsBox      = nullptr;
 
 static std::string g_message;
 static std::string g_messageType = "info";
 static Fl_Box* g_messageBox = nullptr;   // if not already defined
 
+// ------------------ Frames ------------------
+
+static const int FRAME_QUEUE_CARS = 32;  // queued car ids copied per frame
+
+// Copy of what the view draws, so a lot can be captured on one thread and
+// drawn on another. Sizes and versions are copied for every lane, car ids
+// only for the lanes drawn with their cars (the detail lanes).
+struct LotFrame {
+    int numStacks = 0;
+    int stackCapacity = 0;
+    std::vector<int> laneSizes;
+    std::vector<std::uint32_t> laneVersions;
+    int detailFirst = 0;                       // 0-based lane of detailCars[0]
+    std::vector<std::vector<int>> detailCars;  // per detail lane, top first
+    int queueSize = 0;
+    std::vector<int> queueFront;               // first FRAME_QUEUE_CARS queued ids
+
+    // Filled in by the simulation, zero otherwise
+    long long operations = 0;
+    double opsPerSecond = 0;
+    double simulatedSeconds = 0;
+};
+
+// Copy lot into frame, with car ids for lanes [detailFirst, detailEnd).
+// Reuses frame's buffers. Caller must be the only thread using lot.
+// Time Complexity: O(n + d) for n stacks and d cars in the detail lanes
+void captureFrame(const ParkingLot &lot, int detailFirst, int detailEnd, LotFrame &frame) {
+    int n = lot.getNumStacks();
+    frame.numStacks     = n;
+    frame.stackCapacity = lot.getStackCapacity();
+    frame.laneSizes.resize(n);
+    frame.laneVersions.resize(n);
+    for (int lane = 0; lane < n; ++lane) {
+        frame.laneSizes[lane]    = lot.getStack(lane + 1).size();
+        frame.laneVersions[lane] = lot.getLaneVersion(lane + 1);
+    }
+
+    detailFirst = std::max(0, std::min(detailFirst, n));
+    detailEnd   = std::max(detailFirst, std::min(detailEnd, n));
+    frame.detailFirst = detailFirst;
+    frame.detailCars.resize(detailEnd - detailFirst);
+    for (int lane = detailFirst; lane < detailEnd; ++lane) {
+        std::vector<int> &cars = frame.detailCars[lane - detailFirst];
+        cars.clear();
+        for (const Car* car = lot.getStack(lane + 1).topCar(); car != nullptr; car = car->next) {
+            cars.push_back(car->carId);
+        }
+    }
+
+    const Queue &queue = lot.getEntranceQueue();
+    frame.queueSize = queue.size();
+    frame.queueFront.clear();
+    for (const Car* car = queue.frontCar();
+         car != nullptr && (int)frame.queueFront.size() < FRAME_QUEUE_CARS; car = car->next) {
+        frame.queueFront.push_back(car->carId);
+    }
+}
+
 // ------------------ Visualization widget ------------------
 
+// Draws the entrance queue and the lanes of a ParkingLot, either a lot owned
+// by the UI thread (setLot, captured before each draw) or frames published by
+// the simulation (showFrame). Only what fits in
+// the view is drawn: the mouse wheel zooms around the pointer, dragging pans
+// and a double click fits all lanes again. Wide lanes show their cars, narrow
+// ones a fill bar, and lanes narrower than BAR_LANE_PX are merged into
+// columns that show their mean fill.
+//
+// redraw() repaints everything; refresh() repaints the queue row and only
+// the visible lanes whose ParkingLot::getLaneVersion moved since last drawn.
 class ParkingView : public Fl_Widget {
-public:
-    ParkingView(int X, int Y, int W, int H, const char* L = 0)
-        : Fl_Widget(X, Y, W, H, L) {}
+private:
+    enum class Mode { Cars, Bars, Columns };
+
+    static const int MARGIN = 10;
+    static const int QUEUE_ROW_H = 80;
+    static const int DETAIL_LANE_PX = 36;  // narrower lanes are drawn as fill bars
+    static const int DETAIL_CAR_PX = 14;   // and so are lanes whose cars would be shorter
+    static const int BAR_LANE_PX = 2;      // narrower lanes are merged into columns
+    static const int COLUMN_PX = 2;        // width of one merged column
+    static constexpr double MAX_LANE_PX = 240.0;
+
+    const ParkingLot* lot = nullptr;  // not owned; nullptr when showing frames
+    LotFrame frame;                   // what is drawn
+    bool fitted = true;               // all lanes fill the width (follows resizes)
+    double lanePx = 1;                // width of one lane in pixels
+    double firstLane = 0;             // lane at the left edge, fractional
+    int dragX = 0;
+    std::vector<std::uint32_t> drawnVersions;  // per lane, the version last painted
+
+    int areaX() const { return x() + MARGIN; }
+    int areaW() const { return w() - 2 * MARGIN; }
+    int queueY() const { return y() + MARGIN; }
+    int lanesY() const { return queueY() + QUEUE_ROW_H + 20; }
+    int lanesH() const { return h() - 2 * MARGIN - QUEUE_ROW_H - 30; }
+
+    // Height of one car in Cars mode
+    int carHeight() const { return (lanesH() - 30) / frame.stackCapacity - 4; }
+
+    Mode mode() const {
+        if (lanePx < BAR_LANE_PX) return Mode::Columns;
+        if (lanePx >= DETAIL_LANE_PX && carHeight() >= DETAIL_CAR_PX) return Mode::Cars;
+        return Mode::Bars;
+    }
 
-    void draw() override {
-        fl_push_clip(x(), y(), w(), h());
-        fl_rectf(x(), y(), w(), h(), fl_rgb_color(245, 248, 255));
+    // Screen x of the left edge of lane (may lie outside the view)
+    int pixelOf(int lane) const { return areaX() + (int)std::floor((lane - firstLane) * lanePx); }
+
+    // Lane under screen x, clamped to 0..n
+    int laneAt(int px) const {
+        double lane = std::floor(firstLane + (px - areaX()) / lanePx);
+        return (int)std::max(0.0, std::min(lane, (double)frame.numStacks));
+    }
+
+    // Apply the fitted view, or keep a zoomed one within the lanes
+    void clampView() {
+        int n = frame.numStacks;
+        double fitPx = (double)areaW() / n;
+        if (lanePx <= fitPx) fitted = true;
+        if (fitted) {
+            lanePx = fitPx;
+            firstLane = 0;
+            return;
+        }
+        lanePx = std::min(lanePx, std::max(MAX_LANE_PX, fitPx));
+        double lastFirst = std::max(0.0, n - areaW() / lanePx);
+        firstLane = std::max(0.0, std::min(firstLane, lastFirst));
+    }
+
+    void zoomAt(int px, double factor) {
+        clampView();
+        double anchor = firstLane + (px - areaX()) / lanePx;  // keep this lane under the pointer
+        fitted = false;
+        lanePx *= factor;
+        firstLane = anchor - (px - areaX()) / lanePx;
+        clampView();
+        redraw();
+    }
 
-        int margin = 10;
-        int innerX = x() + margin;
-        int innerY = y() + margin;
-        int innerW = w() - 2 * margin;
-        int innerH = h() - 2 * margin;
+    static Fl_Color fillColor(double fill) {
+        if (fill >= 1.0) return fl_rgb_color(220, 38, 38);
+        return fl_color_average(fl_rgb_color(245, 158, 11), fl_rgb_color(34, 197, 94), (float)fill);
+    }
 
-        // Entrance queue
-        int queueH = 80;
-        fl_draw_box(FL_UP_BOX, innerX, innerY, innerW, queueH, fl_rgb_color(255, 255, 255));
+    // Queue row, drawing only the cars that fit in the width.
+    // Time Complexity: O(cars shown)
+    void drawQueue() {
+        int innerX = areaX();
+        int innerY = queueY();
+        int innerW = areaW();
+        fl_draw_box(FL_UP_BOX, innerX, innerY, innerW, QUEUE_ROW_H, fl_rgb_color(255, 255, 255));
         fl_color(0);
         fl_draw("Entrance Queue", innerX + 5, innerY + 15);
 
@@ -67,103 +217,441 @@ public:
         int boxH = 30;
         int gap  = 6;
 
-        if (g_entranceQueue.empty()) {
+        if (frame.queueSize == 0) {
             fl_color(120);
             fl_draw("Queue is empty", qx, qy + 20);
-        } else {
-            fl_color(120);
-            fl_draw("Front →", qx, qy - 5);
-            qx += 60;
-            for (size_t i = 0; i < g_entranceQueue.size(); ++i) {
-                fl_color(fl_rgb_color(198, 210, 255));
-                fl_rectf(qx, qy, boxW, boxH);
-                fl_color(fl_rgb_color(80, 80, 160));
-                fl_rect(qx, qy, boxW, boxH);
-
-                std::string id = std::to_string(g_entranceQueue[i]);
-                fl_color(fl_rgb_color(20, 20, 80));
-                fl_draw(id.c_str(), qx + 10, qy + 20);
-
-                qx += boxW + gap;
-                if (i < g_entranceQueue.size() - 1) {
-                    fl_color(120);
-                    fl_draw("→", qx, qy + 20);
-                    qx += 15;
+            return;
+        }
+
+        fl_color(120);
+        fl_draw("Front →", qx, qy - 5);
+        qx += 60;
+        int right = innerX + innerW - 90;  // room for the "+N more" / rear label
+        int shown = 0;
+        char id[16];
+        for (; shown < (int)frame.queueFront.size() && qx + boxW <= right; ++shown) {
+            fl_color(fl_rgb_color(198, 210, 255));
+            fl_rectf(qx, qy, boxW, boxH);
+            fl_color(fl_rgb_color(80, 80, 160));
+            fl_rect(qx, qy, boxW, boxH);
+
+            std::snprintf(id, sizeof(id), "%d", frame.queueFront[shown]);
+            fl_color(fl_rgb_color(20, 20, 80));
+            fl_draw(id, qx + 10, qy + 20);
+
+            qx += boxW + gap;
+            if (shown + 1 < frame.queueSize) {
+                fl_color(120);
+                fl_draw("→", qx, qy + 20);
+                qx += 15;
+            }
+        }
+        int hidden = frame.queueSize - shown;
+        fl_color(120);
+        if (hidden > 0) {
+            char more[32];
+            std::snprintf(more, sizeof(more), "+%d more", hidden);
+            fl_draw(more, qx, qy + 20);
+        }
+        fl_draw("← Rear", qx, qy - 5);
+    }
+
+    // One lane with its cars (Cars mode) or its fill bar (Bars mode),
+    // over a cleared slot. Cars of lanes the frame has no ids for are drawn
+    // unlabeled.
+    // Time Complexity: O(k) for k cars in the lane (Cars), O(1) (Bars)
+    void drawLane(int lane, Mode m) {
+        int x0 = pixelOf(lane);
+        int slotW = pixelOf(lane + 1) - x0;
+        int top = lanesY();
+        int height = lanesH();
+        int size = frame.laneSizes[lane];
+
+        if (m == Mode::Bars) {
+            fl_color(fl_rgb_color(255, 255, 255));
+            fl_rectf(x0, top, slotW, height);
+            int barW = slotW >= 4 ? slotW - 1 : slotW;
+            int barH = (int)((long long)(height - 2) * size / frame.stackCapacity);
+            fl_color(fillColor((double)size / frame.stackCapacity));
+            fl_rectf(x0, top + height - 1 - barH, barW, barH);
+            return;
+        }
+
+        fl_color(fl_rgb_color(245, 248, 255));
+        fl_rectf(x0, top, slotW, height);
+
+        int laneMargin = std::min(10, slotW / 8);
+        int laneX      = x0 + laneMargin;
+        int laneWInner = slotW - 2 * laneMargin;
+
+        fl_color(fl_rgb_color(255, 255, 255));
+        fl_rectf(laneX, top, laneWInner, height);
+        fl_color(fl_rgb_color(200, 200, 220));
+        fl_rect(laneX, top, laneWInner, height);
+
+        char label[32];
+        std::snprintf(label, sizeof(label), "Stack %d", lane + 1);
+        fl_color(0);
+        fl_draw(label, laneX + 5, top + 15);
+
+        int carH   = carHeight();
+        int startY = top + 25;
+        int carX   = laneX + 10;
+        int carW   = laneWInner - 20;
+
+        int detail = lane - frame.detailFirst;
+        const std::vector<int>* ids = detail >= 0 && detail < (int)frame.detailCars.size()
+                                          ? &frame.detailCars[detail] : nullptr;
+        for (int pos = 0; pos < size; ++pos) {
+            int carY = startY + pos * (carH + 4);
+
+            if (pos == 0) {
+                fl_color(fl_rgb_color(187, 247, 208));
+                fl_rectf(carX, carY, carW, carH);
+                fl_color(fl_rgb_color(21, 128, 61));
+            } else {
+                fl_color(fl_rgb_color(209, 250, 229));
+                fl_rectf(carX, carY, carW, carH);
+                fl_color(fl_rgb_color(22, 101, 52));
+            }
+            fl_rect(carX, carY, carW, carH);
+            if (!ids) continue;
+
+            std::snprintf(label, sizeof(label), "%d", (*ids)[pos]);
+            fl_color(fl_rgb_color(22, 101, 52));
+            fl_draw(label, carX + 5, carY + carH - 5);
+        }
+    }
+
+    // Mean fill of lanes [first, end) as one bar, over a cleared column.
+    // Time Complexity: O(end - first)
+    void drawColumn(int px, int first, int end) {
+        int top = lanesY();
+        int height = lanesH();
+        long long cars = 0;
+        for (int lane = first; lane < end; ++lane) cars += frame.laneSizes[lane];
+        long long capacity = (long long)(end - first) * frame.stackCapacity;
+        fl_color(fl_rgb_color(255, 255, 255));
+        fl_rectf(px, top, COLUMN_PX, height);
+        if (capacity == 0) return;
+        int barH = (int)((height - 2) * cars / capacity);
+        fl_color(fillColor((double)cars / capacity));
+        fl_rectf(px, top + height - 1 - barH, COLUMN_PX, barH);
+    }
+
+    // Paint visible lanes; with onlyChanged, just those whose version moved.
+    // Time Complexity: O(v) version checks for v visible lanes, plus the
+    // lanes (or columns) repainted
+    void drawLanes(bool onlyChanged) {
+        int n = frame.numStacks;
+        Mode m = mode();
+        fl_push_clip(areaX(), lanesY(), areaW(), lanesH());
+
+        if (m == Mode::Columns) {
+            int end = areaX() + areaW();
+            for (int px = areaX(); px < end; px += COLUMN_PX) {
+                int first = laneAt(px);
+                int last = laneAt(px + COLUMN_PX);
+                bool changed = !onlyChanged;
+                for (int lane = first; lane < last; ++lane) {
+                    std::uint32_t version = frame.laneVersions[lane];
+                    if (drawnVersions[lane] != version) {
+                        drawnVersions[lane] = version;
+                        changed = true;
+                    }
                 }
+                if (changed) drawColumn(px, first, last);
             }
-            fl_color(120);
-            fl_draw("← Rear", qx, qy - 5);
+        } else {
+            int first = laneAt(areaX());
+            int last = std::min(n, laneAt(areaX() + areaW()) + 1);
+            for (int lane = first; lane < last; ++lane) {
+                std::uint32_t version = frame.laneVersions[lane];
+                if (onlyChanged && drawnVersions[lane] == version) continue;
+                drawnVersions[lane] = version;
+                drawLane(lane, m);
+            }
+        }
+
+        fl_pop_clip();
+    }
+
+public:
+    ParkingView(int X, int Y, int W, int H, const char* L = 0)
+        : Fl_Widget(X, Y, W, H, L) {}
+
+    // Show newLot (not owned; nullptr for none), zoomed out to fit.
+    void setLot(const ParkingLot* newLot) {
+        lot = newLot;
+        frame = LotFrame();
+        if (lot) {
+            frame.numStacks     = lot->getNumStacks();
+            frame.stackCapacity = lot->getStackCapacity();
+        }
+        fitted = true;
+        drawnVersions.clear();
+        redraw();
+    }
+
+    // Show a frame captured on another thread. Swaps it with the frame shown
+    // so far, handing that buffer back to the caller for reuse.
+    void showFrame(LotFrame &next) {
+        bool reshaped = lot != nullptr || next.numStacks != frame.numStacks ||
+                        next.stackCapacity != frame.stackCapacity;
+        bool newDetail = next.detailFirst != frame.detailFirst ||
+                         next.detailCars.size() != frame.detailCars.size();
+        lot = nullptr;
+        std::swap(frame, next);
+        if (reshaped) {
+            fitted = true;
+            drawnVersions.clear();
+            redraw();
+        } else if (newDetail) {
+            redraw();  // lanes drawn unlabeled before now have ids
+        } else {
+            refresh();
+        }
+    }
+
+    // Lanes [first, end) drawn with their cars, whose ids a frame must carry.
+    void detailLanes(int &first, int &end) const {
+        first = end = 0;
+        if (frame.numStacks == 0 || mode() != Mode::Cars) return;
+        first = laneAt(areaX());
+        end   = std::min(frame.numStacks, laneAt(areaX() + areaW()) + 1);
+    }
+
+    // Repaint after lot operations: the queue row and the changed lanes.
+    void refresh() {
+        damage(FL_DAMAGE_USER1);
+    }
+
+    void draw() override {
+        int n = frame.numStacks;
+        bool partial = damage() == FL_DAMAGE_USER1 && n > 0 && drawnVersions.size() == (std::size_t)n;
+        if (n > 0 && !partial) clampView();
+        if (lot) {
+            int first, end;
+            detailLanes(first, end);
+            captureFrame(*lot, first, end, frame);
         }
 
-        // Stacks
-        int stacksY = innerY + queueH + 20;
-        int stacksH = innerH - queueH - 30;
+        fl_push_clip(x(), y(), w(), h());
+        if (!partial) fl_rectf(x(), y(), w(), h(), fl_rgb_color(245, 248, 255));
+        drawQueue();
 
-        if (!g_initialized) {
+        if (n == 0) {
             fl_color(120);
-            fl_draw("Parking lot is not initialized.", innerX + 10, stacksY + 20);
+            fl_draw("Parking lot is not initialized.", areaX() + 10, lanesY() + 20);
             fl_pop_clip();
             return;
         }
 
-        int n = g_numStacks;
-        if (n <= 0) {
-            fl_pop_clip();
-            return;
+        if (!partial) {
+            drawnVersions.assign(n, 0);
+
+            Mode m = mode();
+            if (m != Mode::Cars) {
+                fl_color(fl_rgb_color(200, 200, 220));
+                fl_rect(areaX() - 1, lanesY() - 1, areaW() + 2, lanesH() + 2);
+            }
+            char status[160];
+            std::snprintf(status, sizeof(status),
+                          "Stacks %d-%d of %d (%s)   wheel: zoom   drag: pan   double-click: fit",
+                          laneAt(areaX()) + 1, std::min(n, laneAt(areaX() + areaW()) + 1), n,
+                          m == Mode::Cars ? "cars" : m == Mode::Bars ? "fill per stack" : "mean fill per column");
+            fl_color(120);
+            fl_draw(status, areaX(), lanesY() - 5);
         }
+        drawLanes(partial);
 
-        int laneW      = innerW / n;
-        int laneMargin = 10;
+        fl_pop_clip();
+    }
 
-        for (int i = 0; i < n; ++i) {
-            int laneX      = innerX + i * laneW + laneMargin;
-            int laneWInner = laneW - 2 * laneMargin;
+    int handle(int event) override {
+        if (frame.numStacks == 0) return Fl_Widget::handle(event);
+        switch (event) {
+        case FL_MOUSEWHEEL:
+            if (Fl::event_dy() == 0) return 0;
+            zoomAt(Fl::event_x(), Fl::event_dy() < 0 ? 1.25 : 0.8);
+            return 1;
+        case FL_PUSH:
+            if (Fl::event_clicks() > 0) {  // double click
+                fitted = true;
+                redraw();
+            }
+            dragX = Fl::event_x();
+            return 1;
+        case FL_DRAG:
+            if (!fitted && Fl::event_x() != dragX) {
+                firstLane -= (Fl::event_x() - dragX) / lanePx;
+                clampView();
+                redraw();
+            }
+            dragX = Fl::event_x();
+            return 1;
+        case FL_RELEASE:
+            return 1;
+        }
+        return Fl_Widget::handle(event);
+    }
+};
 
-            fl_color(fl_rgb_color(255, 255, 255));
-            fl_rectf(laneX, stacksY, laneWInner, stacksH);
-            fl_color(fl_rgb_color(200, 200, 220));
-            fl_rect(laneX, stacksY, laneWInner, stacksH);
-
-            std::string label = "Stack " + std::to_string(i + 1);
-            fl_color(0);
-            fl_draw(label.c_str(), laneX + 5, stacksY + 15);
-
-            if (i < (int)g_stacks.size()) {
-                auto &st = g_stacks[i];
-                int maxCars = g_stackCapacity > 0 ? g_stackCapacity : (int)st.size();
-                int availH  = stacksH - 30;
-                int carH    = maxCars > 0 ? std::max(18, availH / maxCars - 4) : 20;
-                int startY  = stacksY + 25;
-
-                for (size_t pos = 0; pos < st.size(); ++pos) {
-                    int carY = startY + pos * (carH + 4);
-                    int carX = laneX + 10;
-                    int carW = laneWInner - 20;
-
-                    if (pos == 0) {
-                        fl_color(fl_rgb_color(187, 247, 208));
-                        fl_rectf(carX, carY, carW, carH);
-                        fl_color(fl_rgb_color(21, 128, 61));
-                    } else {
-                        fl_color(fl_rgb_color(209, 250, 229));
-                        fl_rectf(carX, carY, carW, carH);
-                        fl_color(fl_rgb_color(22, 101, 52));
-                    }
-                    fl_rect(carX, carY, carW, carH);
+// ------------------ Simulation ------------------
+
+// Drives its own ParkingLot with a WorkloadGenerator stream on a background
+// thread, so the UI thread only ever picks up finished frames.
+//
+// The worker runs in slices of FRAME_SECONDS: it applies the operations the
+// target rate allows for the slice (0 = as many as fit), captures a frame
+// into its back buffer and swaps that with the published one. takeFrame
+// swaps the published frame out again, so the three buffers (worker, shared,
+// view) are reused and no frame is copied.
+class Simulation {
+private:
+    static constexpr double FRAME_SECONDS = 1.0 / 30;
+
+    ParkingLot* lot;  // owned until release()
+    WorkloadGenerator generator;
+    std::thread worker;
+
+    std::atomic<bool> stopping;
+    std::atomic<double> targetRate;         // operations per second, 0 = unlimited
+    std::atomic<int> detailFirst, detailEnd;
+
+    std::mutex frameLock;                   // guards published and fresh
+    std::condition_variable wake;           // cuts the worker's sleep short on stop
+    LotFrame building;                      // worker only
+    LotFrame published;
+    bool fresh = false;                     // published not taken yet
+
+    Simulation(const Simulation&) = delete;
+    Simulation& operator=(const Simulation&) = delete;
+
+    static WorkloadConfig workload(int stacks, int capacity, unsigned seed) {
+        WorkloadConfig config;
+        config.seed          = seed;
+        config.numStacks     = stacks;
+        config.stackCapacity = capacity;
+        return config;
+    }
 
-                    std::string cid = std::to_string(st[pos]);
-                    fl_color(fl_rgb_color(22, 101, 52));
-                    fl_draw(cid.c_str(), carX + 5, carY + carH - 5);
-                }
+    void run() {
+        typedef std::chrono::steady_clock Clock;
+        long long operations = 0;
+        double credit = 0;  // operations the rate allows but not yet applied
+        Clock::time_point sliceStart = Clock::now();
+        Clock::time_point lastFrame = sliceStart;
+        long long operationsAtLastFrame = 0;
+
+        while (!stopping.load(std::memory_order_relaxed)) {
+            Clock::time_point sliceEnd =
+                sliceStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(FRAME_SECONDS));
+            double rate = targetRate.load(std::memory_order_relaxed);
+            long long budget = LLONG_MAX;
+            if (rate > 0) {
+                credit += rate * FRAME_SECONDS;
+                budget = (long long)credit;
+                credit -= budget;
+            }
+
+            // Check the clock only now and then; stop at the slice end if the
+            // rate is more than this thread can do
+            long long done = 0;
+            while (done < budget) {
+                applyTraceRecord(*lot, generator.next());
+                ++done;
+                if ((done & 255) == 0 && Clock::now() >= sliceEnd) break;
+            }
+            operations += done;
+
+            Clock::time_point now = Clock::now();
+            double elapsed = std::chrono::duration<double>(now - lastFrame).count();
+            captureFrame(*lot, detailFirst.load(std::memory_order_relaxed),
+                         detailEnd.load(std::memory_order_relaxed), building);
+            building.operations       = operations;
+            building.opsPerSecond     = elapsed > 0 ? (operations - operationsAtLastFrame) / elapsed : 0;
+            building.simulatedSeconds = generator.clock();
+            lastFrame = now;
+            operationsAtLastFrame = operations;
+
+            std::unique_lock<std::mutex> guard(frameLock);
+            std::swap(building, published);
+            fresh = true;
+            if (now < sliceEnd) {
+                wake.wait_until(guard, sliceEnd, [this] { return stopping.load(); });
+                sliceStart = sliceEnd;
+            } else {
+                sliceStart = now;  // behind: don't try to catch up
             }
         }
+    }
 
-        fl_pop_clip();
+public:
+    // Start on a new, empty lot of the given shape.
+    // Time Complexity: O(n * m) to build the lot and the generator's shadow
+    Simulation(int stacks, int capacity, double opsPerSecond, unsigned seed)
+        : lot(new ParkingLot(stacks, capacity)),
+          generator(workload(stacks, capacity, seed)),
+          stopping(false),
+          targetRate(opsPerSecond),
+          detailFirst(0),
+          detailEnd(0) {
+        worker = std::thread(&Simulation::run, this);
+    }
+
+    ~Simulation() {
+        delete release();
+    }
+
+    // Time Complexity: O(1)
+    void setRate(double opsPerSecond) {
+        targetRate.store(opsPerSecond, std::memory_order_relaxed);
+    }
+
+    // Lanes whose car ids later frames should carry (see ParkingView::detailLanes).
+    // Time Complexity: O(1)
+    void setDetailLanes(int first, int end) {
+        detailFirst.store(first, std::memory_order_relaxed);
+        detailEnd.store(end, std::memory_order_relaxed);
+    }
+
+    // Swap the latest frame into out if one was published since the last
+    // call; out's old buffer goes back to the worker.
+    // Time Complexity: O(1)
+    bool takeFrame(LotFrame &out) {
+        std::lock_guard<std::mutex> guard(frameLock);
+        if (!fresh) return false;
+        std::swap(published, out);
+        fresh = false;
+        return true;
+    }
+
+    // Stop the worker and hand over the lot (the caller owns it); nullptr
+    // if already released.
+    // Time Complexity: O(1) plus waiting for the current slice to end
+    ParkingLot* release() {
+        if (worker.joinable()) {
+            {
+                std::lock_guard<std::mutex> guard(frameLock);
+                stopping = true;
+            }
+            wake.notify_one();
+            worker.join();
+        }
+        ParkingLot* released = lot;
+        lot = nullptr;
+        return released;
     }
 };
 
 static ParkingView* g_parkingView = nullptr;
 
+static Simulation* g_sim = nullptr;       // running simulation; g_lot is nullptr meanwhile
+static LotFrame g_simFrame;               // buffer swapped with the simulation and view
+static unsigned g_simSeed = 1;
+static const double SIM_TICK_SECONDS = 1.0 / 30;
+
 // ------------------ Message helper ------------------
 
 void showMessage(const std::string& msg, const std::string& type = "info") {
@@ -197,16 +685,47 @@ void showMessage(const std::string& msg, const std::string& type = "info") {
 }
 // ------------------ Helpers ------------------
 
-bool carExists(int carId) {
-    if (std::find(g_entranceQueue.begin(), g_entranceQueue.end(), carId)
-        != g_entranceQueue.end())
-        return true;
+// Shows the error and returns false if the lot cannot be operated on by hand
+bool requireLot() {
+    if (g_sim) {
+        showMessage("Stop the simulation first", "error");
+        return false;
+    }
+    if (!g_lot) {
+        showMessage("Initialize parking lot first", "error");
+        return false;
+    }
+    return true;
+}
 
-    for (auto &st : g_stacks) {
-        if (std::find(st.begin(), st.end(), carId) != st.end())
-            return true;
+// Picks up the simulation's latest frame (without waiting for it) and
+// tells it which lanes the view needs car ids for
+void cb_simulationTick(void*) {
+    int first, end;
+    g_parkingView->detailLanes(first, end);
+    g_sim->setDetailLanes(first, end);
+
+    if (g_sim->takeFrame(g_simFrame)) {
+        static char stats[160];  // label text must outlive this call
+        int minutes = (int)(g_simFrame.simulatedSeconds / 60);
+        std::snprintf(stats, sizeof(stats), "%.0f ops/s   %lld ops   queue %d   day %d %02d:%02d",
+                      g_simFrame.opsPerSecond, g_simFrame.operations, g_simFrame.queueSize,
+                      minutes / (24 * 60), minutes / 60 % 24, minutes % 60);
+        g_simStatsBox->label(stats);
+        g_simStatsBox->redraw();
+        g_parkingView->showFrame(g_simFrame);
     }
-    return false;
+    Fl::repeat_timeout(SIM_TICK_SECONDS, cb_simulationTick);
+}
+
+// Stop a running simulation; its lot becomes g_lot
+void endSimulation() {
+    if (!g_sim) return;
+    Fl::remove_timeout(cb_simulationTick);
+    g_lot = g_sim->release();
+    delete g_sim;
+    g_sim = nullptr;
+    if (g_parkingView) g_parkingView->setLot(g_lot);
 }
 
 // ------------------ Callbacks ------------------
@@ -220,22 +739,17 @@ void cb_initialize(Fl_Widget*, void*) {
         return;
     }
 
-    g_numStacks      = n;
-    g_stackCapacity  = c;
-    g_stacks.assign(g_numStacks, std::vector<int>());
-    g_entranceQueue.clear();
-    g_nextCarId      = 1;
-    g_initialized    = true;
+    endSimulation();
+    delete g_lot;
+    g_lot       = new ParkingLot(n, c);
+    g_nextCarId = 1;
 
     showMessage("Parking lot initialized", "success");
-    if (g_parkingView) g_parkingView->redraw();
+    if (g_parkingView) g_parkingView->setLot(g_lot);
 }
 
 void cb_addCar(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
-        return;
-    }
+    if (!requireLot()) return;
 
     std::string val = g_addCarIdInput->value();
     int carId;
@@ -245,100 +759,75 @@ void cb_addCar(Fl_Widget*, void*) {
         carId = std::atoi(val.c_str());
     }
 
-    if (carExists(carId)) {
+    if (g_lot->addCarToEntrance(carId) == LotStatus::DuplicateCar) {
         showMessage("Error: car already exists in system", "error");
         return;
     }
 
-    g_entranceQueue.push_back(carId);
     g_addCarIdInput->value("");
     showMessage("Car added to entrance queue", "success");
-    if (g_parkingView) g_parkingView->redraw();
+    if (g_parkingView) g_parkingView->refresh();
 }
 
 void cb_parkFirst(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
-        return;
-    }
-    if (g_entranceQueue.empty()) {
+    if (!requireLot()) return;
+
+    ParkResult result = g_lot->parkCarInFirstAvailableStack();
+    if (result.status == LotStatus::QueueEmpty) {
         showMessage("Entrance queue is empty", "error");
         return;
     }
-
-    int carId = g_entranceQueue.front();
-    g_entranceQueue.erase(g_entranceQueue.begin());
-
-    for (int i = 0; i < g_numStacks; ++i) {
-        if ((int)g_stacks[i].size() < g_stackCapacity) {
-            g_stacks[i].insert(g_stacks[i].begin(), carId);
-            showMessage("Car parked in stack " + std::to_string(i + 1), "success");
-            if (g_parkingView) g_parkingView->redraw();
-            return;
-        }
+    if (result.status == LotStatus::ParkingFull) {
+        showMessage("Parking full, car cannot be parked", "error");
+    } else {
+        showMessage("Car parked in stack " + std::to_string(result.stackIndex), "success");
     }
-
-    showMessage("Parking full, car cannot be parked", "error");
-    if (g_parkingView) g_parkingView->redraw();
+    if (g_parkingView) g_parkingView->refresh();
 }
 
 void cb_parkSpecific(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
-        return;
-    }
-    if (g_entranceQueue.empty()) {
+    if (!requireLot()) return;
+    if (g_lot->getEntranceQueue().isEmpty()) {
         showMessage("Entrance queue is empty", "error");
         return;
     }
 
-    int idx = std::atoi(g_stackIndexInput->value()) - 1;
-    if (idx < 0 || idx >= g_numStacks) {
+    int stackIndex = std::atoi(g_stackIndexInput->value());
+    if (stackIndex < 1 || stackIndex > g_lot->getNumStacks()) {
         showMessage("Invalid stack number", "error");
         return;
     }
-    if ((int)g_stacks[idx].size() >= g_stackCapacity) {
+    // Checked here so the car keeps waiting (the engine would drop it)
+    if (g_lot->getStack(stackIndex).isFull()) {
         showMessage("Selected stack is full", "error");
         return;
     }
 
-    int carId = g_entranceQueue.front();
-    g_entranceQueue.erase(g_entranceQueue.begin());
-    g_stacks[idx].insert(g_stacks[idx].begin(), carId);
+    g_lot->parkCarInSpecificStack(stackIndex);
 
-    showMessage("Car parked in stack " + std::to_string(idx + 1), "success");
+    showMessage("Car parked in stack " + std::to_string(stackIndex), "success");
     g_stackIndexInput->value("");
-    if (g_parkingView) g_parkingView->redraw();
+    if (g_parkingView) g_parkingView->refresh();
 }
 
 void cb_findCar(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
-        return;
-    }
+    if (!requireLot()) return;
 
     int carId = std::atoi(g_findCarInput->value());
-    for (int i = 0; i < g_numStacks; ++i) {
-        auto &st = g_stacks[i];
-        auto it  = std::find(st.begin(), st.end(), carId);
-        if (it != st.end()) {
-            int pos = (int)(it - st.begin()) + 1; // 1-based from top
-            std::ostringstream oss;
-            oss << "Car " << carId << " found in stack " << (i + 1)
-                << " at position " << pos << " from top";
-            showMessage(oss.str(), "success");
-            return;
-        }
+    int stackIndex, position;
+    if (g_lot->findCar(carId, stackIndex, position)) {
+        std::ostringstream oss;
+        oss << "Car " << carId << " found in stack " << stackIndex
+            << " at position " << position << " from top";
+        showMessage(oss.str(), "success");
+        return;
     }
 
     showMessage("Car not found in any stack", "error");
 }
 
 void cb_moveCar(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
-        return;
-    }
+    if (!requireLot()) return;
 
     std::string carText = g_moveCarIdInput->value();
     if (carText.empty()) {
@@ -352,60 +841,45 @@ void cb_moveCar(Fl_Widget*, void*) {
         showMessage("Please enter the target stack number", "error");
         return;
     }
-    int target = std::atoi(targetText.c_str()) - 1;
+    int target = std::atoi(targetText.c_str());
 
-    if (target < 0 || target >= g_numStacks) {
+    if (target < 1 || target > g_lot->getNumStacks()) {
         showMessage("Invalid target stack number", "error");
         return;
     }
 
-    // find source stack
-    int source = -1;
-    for (int i = 0; i < g_numStacks; ++i) {
-        auto &st = g_stacks[i];
-        auto it  = std::find(st.begin(), st.end(), carId);
-        if (it != st.end()) {
-            source = i;
-            break;
-        }
-    }
-
-    if (source == -1) {
+    int source, position;
+    if (!g_lot->findCar(carId, source, position)) {
         showMessage("Car not found in any stack", "error");
         return;
     }
-
-    auto &src = g_stacks[source];
-    auto &dst = g_stacks[target];
-
-    if (src.empty() || src.front() != carId) {
+    if (position != 1) {
         showMessage("Cannot move: car is not at the top of its stack", "error");
         return;
     }
 
-    if ((int)dst.size() >= g_stackCapacity) {
+    LotStatus status = g_lot->moveTopCar(source, target);
+    if (status == LotStatus::StackFull) {
         showMessage("Target stack is full", "error");
         return;
     }
-
-    src.erase(src.begin());
-    dst.insert(dst.begin(), carId);
+    if (status == LotStatus::SameStack) {
+        showMessage("Car is already in that stack", "warning");
+        return;
+    }
 
     std::ostringstream oss;
-    oss << "Car " << carId << " moved from stack " << (source + 1)
-        << " to stack " << (target + 1);
+    oss << "Car " << carId << " moved from stack " << source
+        << " to stack " << target;
     showMessage(oss.str(), "success");
 
     g_moveCarIdInput->value("");
     g_targetStackInput->value("");
-    if (g_parkingView) g_parkingView->redraw();
+    if (g_parkingView) g_parkingView->refresh();
 }
 
 void cb_exitCar(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
-        return;
-    }
+    if (!requireLot()) return;
 
     std::string carStr = g_exitCarIdInput->value();
     if (carStr.empty()) {
@@ -414,41 +888,54 @@ void cb_exitCar(Fl_Widget*, void*) {
     }
     int carId = std::atoi(carStr.c_str());
 
-    // 1) try to remove if car is at top of some stack
-    for (int i = 0; i < g_numStacks; ++i) {
-        auto &st = g_stacks[i];
-        if (!st.empty() && st.front() == carId) {
-            st.erase(st.begin());
-            std::ostringstream oss;
-            oss << "Car " << carId << " exited from top of stack " << (i + 1);
-            showMessage(oss.str(), "success");
-            g_exitCarIdInput->value("");
-            if (g_parkingView) g_parkingView->redraw();
-            return;
-        }
+    int stackIndex, position;
+    if (!g_lot->findCar(carId, stackIndex, position)) {
+        showMessage("Car not found in any stack", "error");
+        return;
+    }
+    if (g_lot->exitCarFromStackTop(carId, stackIndex) == LotStatus::NotOnTop) {
+        showMessage("Cannot remove: car is not at the top of its stack", "error");
+        return;
     }
 
-    // 2) check if exists deeper
-    bool exists = false;
-    for (auto &st : g_stacks) {
-        if (std::find(st.begin(), st.end(), carId) != st.end()) {
-            exists = true;
-            break;
-        }
+    std::ostringstream oss;
+    oss << "Car " << carId << " exited from top of stack " << stackIndex;
+    showMessage(oss.str(), "success");
+    g_exitCarIdInput->value("");
+    if (g_parkingView) g_parkingView->refresh();
+}
+
+void cb_retrieveCar(Fl_Widget*, void*) {
+    if (!requireLot()) return;
+
+    std::string carStr = g_exitCarIdInput->value();
+    if (carStr.empty()) {
+        showMessage("Please enter the Car ID to retrieve", "error");
+        return;
     }
+    int carId = std::atoi(carStr.c_str());
 
-    if (exists) {
-        showMessage("Cannot remove: car is not at the top of its stack", "error");
-    } else {
+    RetrieveResult result = g_lot->retrieveCar(carId);
+    if (result.status == LotStatus::CarNotFound) {
         showMessage("Car not found in any stack", "error");
+        return;
     }
-}
-void cb_sortStack(Fl_Widget*, void*) {
-    if (!g_initialized) {
-        showMessage("Initialize parking lot first", "error");
+    if (result.status == LotStatus::NotEnoughSpace) {
+        showMessage("Not enough free space in the other stacks to clear the way", "error");
         return;
     }
 
+    std::ostringstream oss;
+    oss << "Car " << carId << " retrieved from stack " << result.stackIndex
+        << " after relocating " << result.moves.size() << " cars";
+    showMessage(oss.str(), "success");
+    g_exitCarIdInput->value("");
+    if (g_parkingView) g_parkingView->refresh();
+}
+
+void cb_sortStack(Fl_Widget*, void*) {
+    if (!requireLot()) return;
+
     if (!g_sortStackInput) {
         showMessage("Internal error: sort input not created", "error");
         return;
@@ -460,25 +947,63 @@ void cb_sortStack(Fl_Widget*, void*) {
         return;
     }
 
-    int idx = std::atoi(s.c_str()) - 1;
-    if (idx < 0 || idx >= g_numStacks) {
+    int stackIndex = std::atoi(s.c_str());
+    if (g_lot->sortStack(stackIndex) == LotStatus::InvalidStack) {
         showMessage("Invalid stack number", "error");
         return;
     }
 
-    auto &st = g_stacks[idx];
-    std::sort(st.begin(), st.end());
-    showMessage("Sorted stack " + std::to_string(idx + 1), "success");
-    if (g_parkingView) g_parkingView->redraw();
+    showMessage("Sorted stack " + std::to_string(stackIndex), "success");
+    if (g_parkingView) g_parkingView->refresh();
 }
 
 void cb_reset(Fl_Widget*, void*) {
-    g_initialized = false;
-    g_stacks.clear();
-    g_entranceQueue.clear();
+    endSimulation();
+    if (g_parkingView) g_parkingView->setLot(nullptr);
+    delete g_lot;
+    g_lot       = nullptr;
     g_nextCarId = 1;
     showMessage("System reset. Please initialize again.", "info");
-    if (g_parkingView) g_parkingView->redraw();
+}
+
+void cb_runSimulation(Fl_Widget*, void*) {
+    double rate = std::atof(g_rateInput->value());
+    if (rate < 0) {
+        showMessage("Please enter a rate of 0 (unlimited) or more", "error");
+        return;
+    }
+    std::string rateText = rate > 0 ? std::to_string((long long)rate) + " ops/s" : "full speed";
+
+    if (g_sim) {
+        g_sim->setRate(rate);
+        showMessage("Simulation rate set to " + rateText, "success");
+        return;
+    }
+
+    int n = std::atoi(g_numStacksInput->value());
+    int c = std::atoi(g_capacityInput->value());
+    if (n < 1 || c < 1) {
+        showMessage("Please enter valid positive numbers", "error");
+        return;
+    }
+
+    // The generated stream is only valid for a fresh lot
+    if (g_parkingView) g_parkingView->setLot(nullptr);
+    delete g_lot;
+    g_lot = nullptr;
+    g_sim = new Simulation(n, c, rate, g_simSeed++);
+    Fl::add_timeout(SIM_TICK_SECONDS, cb_simulationTick);
+    showMessage("Simulation running at " + rateText + " on a new lot", "success");
+}
+
+void cb_stopSimulation(Fl_Widget*, void*) {
+    if (!g_sim) {
+        showMessage("No simulation is running", "warning");
+        return;
+    }
+    endSimulation();
+    g_simStatsBox->label("");
+    showMessage("Simulation stopped; the lot stays loaded for manual operations", "info");
 }
 
 // ------------------ main (GUI) ------------------
@@ -635,7 +1160,33 @@ int main(int argc, char** argv) {
 
         Fl_Button* exitBtn = new Fl_Button(x + 10, y, leftW - 20, 30, "Exit Car from Top");
         exitBtn->callback(cb_exitCar);
-        y += 40;
+        y += 35;
+
+        Fl_Button* retrieveBtn = new Fl_Button(x + 10, y, leftW - 20, 30, "Retrieve Car (relocate cars above)");
+        retrieveBtn->callback(cb_retrieveCar);
+        y += 45;
+
+        // Simulation
+        Fl_Box* simLabel = new Fl_Box(x + 10, y, leftW - 20, 20, "Simulation (new lot of the size above)");
+        simLabel->labelfont(FL_BOLD);
+        y += 25;
+
+        g_rateInput = new Fl_Input(x + 170, y, 80, 25, "Ops/sec (0 = max):");
+        g_rateInput->value("10000");
+        y += 35;
+
+        Fl_Button* runBtn = new Fl_Button(x + 10, y, leftW - 20, 30, "Run Simulation / Set Rate");
+        runBtn->callback(cb_runSimulation);
+        y += 35;
+
+        Fl_Button* stopBtn = new Fl_Button(x + 10, y, leftW - 20, 30, "Stop Simulation");
+        stopBtn->callback(cb_stopSimulation);
+        y += 35;
+
+        g_simStatsBox = new Fl_Box(x + 10, y, leftW - 20, 20, "");
+        g_simStatsBox->labelsize(12);
+        g_simStatsBox->align(FL_ALIGN_LEFT | FL_ALIGN_INSIDE);
+        y += 30;
 
         // scroll's content may extend beyond leftH; scrollbar appears automatically
     }
@@ -648,5 +1199,7 @@ int main(int argc, char** argv) {
     win->resizable(g_parkingView);
     win->show(argc, argv);
 
-    return Fl::run();
+    int result = Fl::run();
+    delete g_sim;  // joins the worker
+    return result;
 }
@@ -0,0 +1,709 @@
+// Self-checks for the parking lot engine. Each mode exits with status 1 on
+// the first failure, so they can be run under sanitizers:
+//   fuzz      random operations on small lots against a plain shadow model
+//             (every car's stack and position compared after each step)
+//   stress    6 threads of mixed operations on a concurrent, journaled lot;
+//             afterwards the index agrees with a lane scan, no node leaked,
+//             and recovering the journal rebuilds the same lot
+//   recovery  snapshot + journal recovery, torn journal tails, snapshot
+//             round trips across lot shapes, rejection of bad snapshots
+//   pool      cars allocated on one thread and freed on another must not
+//             make CarPool carve new slabs without bound
+//   queue     gates and workers on one MpmcQueue: every car comes out exactly
+//             once and in its gate's order, directly and through
+//             ParkingLot::admitFromQueue on a concurrent lot
+//
+// Build (from src/):
+//   g++ -std=c++17 -O2 -pthread -o lot_check lot_check.cpp CarIndex.cpp CarPool.cpp FreeLaneSet.cpp
+//       Journal.cpp LotEvent.cpp MpmcQueue.cpp ParkingLot.cpp Queue.cpp RingQueue.cpp Stack.cpp
+//       ThreadPool.cpp Trace.cpp WorkloadGenerator.cpp
+// Add -fsanitize=thread for stress, pool and queue, -fsanitize=address,undefined for the others.
+// Usage:
+//   lot_check [fuzz|stress|recovery|pool|queue]     (no argument runs all of them)
+// recovery writes lot_check.* scratch files in the working directory.
+
+#include "CarPool.h"
+#include "Journal.h"
+#include "MpmcQueue.h"
+#include "WorkloadGenerator.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+bool check(bool condition, const char* mode, const char* what) {
+    if (!condition) std::printf("FAIL %s: %s\n", mode, what);
+    return condition;
+}
+
+// Same lanes and queue, car for car
+bool sameLot(const ParkingLot &a, const ParkingLot &b) {
+    if (a.getNumStacks() != b.getNumStacks() || a.getStackCapacity() != b.getStackCapacity()) return false;
+    for (int lane = 1; lane <= a.getNumStacks(); ++lane) {
+        const Car* x = a.getStack(lane).topCar();
+        const Car* y = b.getStack(lane).topCar();
+        for (; x != nullptr && y != nullptr; x = x->next, y = y->next) {
+            if (x->carId != y->carId) return false;
+        }
+        if (x != nullptr || y != nullptr) return false;
+    }
+    const Car* x = a.getEntranceQueue().frontCar();
+    const Car* y = b.getEntranceQueue().frontCar();
+    for (; x != nullptr && y != nullptr; x = x->next, y = y->next) {
+        if (x->carId != y->carId) return false;
+    }
+    return x == nullptr && y == nullptr;
+}
+
+// findCar and a lane scan agree for every id below maxId
+bool indexMatchesScan(const ParkingLot &lot, int maxId) {
+    for (int carId = 0; carId < maxId; ++carId) {
+        int s1, p1, s2, p2;
+        bool indexed = lot.findCar(carId, s1, p1);
+        bool scanned = lot.findCarByScan(carId, s2, p2);
+        if (indexed != scanned || (indexed && (s1 != s2 || p1 != p2))) return false;
+    }
+    return true;
+}
+
+// ------------------ fuzz: shadow model ------------------
+
+// The lot as plain vectors: lanes hold their cars bottom first, so back() is the top
+struct ShadowLot {
+    int capacity;
+    std::deque<int> queue;
+    std::vector<std::vector<int>> lanes;
+
+    ShadowLot(int stacks, int cap) : capacity(cap), lanes(stacks) {}
+
+    bool full(int lane) const { return (int)lanes[lane].size() >= capacity; }
+
+    bool locate(int carId, int &stackIndex, int &position) const {
+        for (std::size_t i = 0; i < lanes.size(); ++i) {
+            const std::vector<int> &l = lanes[i];
+            for (int j = (int)l.size() - 1; j >= 0; --j) {
+                if (l[j] == carId) {
+                    stackIndex = (int)i + 1;
+                    position = (int)l.size() - j;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool contains(int carId) const {
+        int s, p;
+        return std::find(queue.begin(), queue.end(), carId) != queue.end() || locate(carId, s, p);
+    }
+
+    void add(int carId) {
+        if (!contains(carId)) queue.push_back(carId);
+    }
+
+    bool parkFirst() {
+        if (queue.empty()) return false;
+        int carId = queue.front();
+        queue.pop_front();
+        for (std::size_t i = 0; i < lanes.size(); ++i) {
+            if (!full((int)i)) {
+                lanes[i].push_back(carId);
+                return true;
+            }
+        }
+        return false;  // lot full: the car is dropped
+    }
+
+    void parkSpecific(int stackIndex) {
+        if (queue.empty()) return;
+        int carId = queue.front();
+        queue.pop_front();
+        if (!full(stackIndex - 1)) lanes[stackIndex - 1].push_back(carId);
+    }
+
+    void exitTop(int carId, int stackIndex) {
+        std::vector<int> &l = lanes[stackIndex - 1];
+        if (!l.empty() && l.back() == carId) l.pop_back();
+    }
+
+    void sort(int stackIndex) {
+        std::vector<int> &l = lanes[stackIndex - 1];
+        std::sort(l.begin(), l.end(), [](int a, int b) { return a > b; });  // smallest on top
+    }
+
+    void move(int source, int target) {
+        if (source == target) return;
+        std::vector<int> &from = lanes[source - 1];
+        for (int t = target - 1; t < (int)lanes.size() && !from.empty(); ++t) {
+            if (t == source - 1) continue;
+            while (!from.empty() && !full(t)) {
+                lanes[t].push_back(from.back());
+                from.pop_back();
+            }
+        }
+    }
+
+    void moveTop(int source, int target) {
+        if (source == target || lanes[source - 1].empty() || full(target - 1)) return;
+        lanes[target - 1].push_back(lanes[source - 1].back());
+        lanes[source - 1].pop_back();
+    }
+
+    // Relocations made, -1 if the car is not parked, -2 if there is no room
+    int retrieve(int carId) {
+        int stackIndex, position;
+        if (!locate(carId, stackIndex, position)) return -1;
+        int own = stackIndex - 1;
+        long room = 0;
+        for (int t = 0; t < (int)lanes.size(); ++t) {
+            if (t != own) room += capacity - (int)lanes[t].size();
+        }
+        if (room < position - 1) return -2;
+        int moved = 0;
+        for (int t = 0; t < (int)lanes.size() && moved < position - 1; ++t) {
+            if (t == own) continue;
+            while (moved < position - 1 && !full(t)) {
+                lanes[t].push_back(lanes[own].back());
+                lanes[own].pop_back();
+                ++moved;
+            }
+        }
+        lanes[own].pop_back();
+        return moved;
+    }
+};
+
+bool runFuzz() {
+    const int ROUNDS = 200;
+    const int OPS = 300;
+    const int IDS = 40;
+    std::mt19937 rng(1);
+    for (int round = 0; round < ROUNDS; ++round) {
+        int stacks = 1 + (int)(rng() % 6);
+        int capacity = 1 + (int)(rng() % 5);
+        ParkingLot lot(stacks, capacity);
+        ShadowLot model(stacks, capacity);
+
+        for (int op = 0; op < OPS; ++op) {
+            int a = 1 + (int)(rng() % stacks);
+            int b = 1 + (int)(rng() % stacks);
+            int carId = (int)(rng() % IDS);
+            switch (rng() % 11) {
+                case 0:
+                case 1:
+                    lot.addCarToEntrance(carId);
+                    model.add(carId);
+                    break;
+                case 2:
+                    lot.parkCarInFirstAvailableStack();
+                    model.parkFirst();
+                    break;
+                case 3:
+                    lot.parkCarInSpecificStack(a);
+                    model.parkSpecific(a);
+                    break;
+                case 4: {
+                    // Usually the real top car, sometimes any id
+                    const std::vector<int> &l = model.lanes[a - 1];
+                    int leaving = !l.empty() && rng() % 2 ? l.back() : carId;
+                    lot.exitCarFromStackTop(leaving, a);
+                    model.exitTop(leaving, a);
+                    break;
+                }
+                case 5:
+                    lot.sortStack(a);
+                    model.sort(a);
+                    break;
+                case 6:
+                    lot.moveBetweenStacks(a, b);
+                    model.move(a, b);
+                    break;
+                case 7: {
+                    int ids[5];
+                    int count = (int)(rng() % 5);
+                    for (int i = 0; i < count; ++i) {
+                        ids[i] = (int)(rng() % IDS);
+                        model.add(ids[i]);
+                    }
+                    lot.addCarsToEntrance(ids, count);
+                    break;
+                }
+                case 8: {
+                    int count = (int)(rng() % 6);
+                    int expected = 0;
+                    for (int i = 0; i < count; ++i) {
+                        bool space = false;
+                        for (int t = 0; t < stacks; ++t) space = space || !model.full(t);
+                        if (!space || !model.parkFirst()) break;
+                        ++expected;
+                    }
+                    if (!check((int)lot.parkBatch(count).size() == expected, "fuzz", "parkBatch count")) return false;
+                    break;
+                }
+                case 9:
+                    lot.moveTopCar(a, b);
+                    model.moveTop(a, b);
+                    break;
+                default: {
+                    RetrieveResult r = lot.retrieveCar(carId);
+                    int got = r.status == LotStatus::Ok ? (int)r.moves.size()
+                            : r.status == LotStatus::CarNotFound ? -1 : -2;
+                    if (!check(got == model.retrieve(carId), "fuzz", "retrieveCar result")) return false;
+                    break;
+                }
+            }
+
+            for (int id = 0; id < IDS; ++id) {
+                int s1 = 0, p1 = 0, s2 = 0, p2 = 0, s3 = 0, p3 = 0;
+                bool found = lot.findCar(id, s1, p1);
+                bool scanned = lot.findCarByScan(id, s2, p2, op % 3 + 1);
+                bool modeled = model.locate(id, s3, p3);
+                if (!check(found == scanned && (!found || (s1 == s2 && p1 == p2)), "fuzz", "findCar vs scan") ||
+                    !check(found == modeled && (!found || (s1 == s3 && p1 == p3)), "fuzz", "lot vs model")) {
+                    std::printf("  round %d, op %d, car %d\n", round, op, id);
+                    return false;
+                }
+            }
+            if (!check(lot.getEntranceQueue().size() == (int)model.queue.size(), "fuzz", "queue length")) {
+                return false;
+            }
+        }
+    }
+    std::printf("fuzz      ok  (%d lots x %d operations)\n", ROUNDS, OPS);
+    return true;
+}
+
+// ------------------ stress: concurrent mode ------------------
+
+bool runStress() {
+    const int THREADS = 6;
+    const int OPS = 20000;
+    const int STACKS = 32;
+    const int CAPACITY = 16;
+    const char* journalPath = "lot_check_stress.journal";
+    std::remove(journalPath);
+
+    std::size_t nodesBefore = CarPool::inUse();
+    bool ok = true;
+    {
+        ParkingLot lot(STACKS, CAPACITY, true);
+        std::atomic<int> nextId(1);
+        {
+            Journal journal(journalPath, STACKS, CAPACITY);
+            lot.setJournal(&journal);
+            std::vector<std::thread> threads;
+            for (int t = 0; t < THREADS; ++t) {
+                threads.emplace_back([&lot, &nextId, t] {
+                    std::mt19937 rng(t);
+                    for (int i = 0; i < OPS; ++i) {
+                        int a = (int)(rng() % STACKS) + 1;
+                        int b = (int)(rng() % STACKS) + 1;
+                        int anyId = (int)(rng() % (unsigned)nextId.load());
+                        int s, p;
+                        switch (rng() % 12) {
+                            case 0:
+                            case 1: lot.addCarToEntrance(nextId++); break;
+                            case 2: lot.parkCarInFirstAvailableStack(); break;
+                            case 3: lot.parkCarInSpecificStack(a); break;
+                            case 4:
+                                if (lot.findCar(anyId, s, p) && p == 1) lot.exitCarFromStackTop(anyId, s);
+                                break;
+                            case 5: lot.findCar(anyId, s, p); break;
+                            case 6: lot.moveBetweenStacks(a, b); break;
+                            case 7:
+                                if (i % 50 == 0) {
+                                    lot.sortStacks(1, STACKS, 2);
+                                } else {
+                                    lot.sortStack(a);
+                                }
+                                break;
+                            case 8: {
+                                int ids[4] = {nextId++, nextId++, nextId++, nextId++};
+                                lot.addCarsToEntrance(ids, 4);
+                                lot.parkBatch(3);
+                                break;
+                            }
+                            case 9: lot.findCarByScan(anyId, s, p, i % 100 == 0 ? 2 : 1); break;
+                            case 10: lot.moveTopCar(a, b); break;
+                            default: lot.retrieveCar(anyId); break;
+                        }
+                    }
+                });
+            }
+            for (std::thread &t : threads) t.join();
+            lot.setJournal(nullptr);
+        }
+
+        int cars = lot.getEntranceQueue().size();
+        for (int lane = 1; lane <= STACKS; ++lane) cars += lot.getStack(lane).size();
+        ok = check(indexMatchesScan(lot, nextId.load()), "stress", "findCar vs scan after the run") &&
+             check(CarPool::inUse() == nodesBefore + (std::size_t)cars, "stress", "pool nodes vs cars in the lot");
+
+        // The journal order must be a valid replay order
+        if (ok) {
+            ParkingLot rebuilt(STACKS, CAPACITY);
+            Journal journal(journalPath, STACKS, CAPACITY);
+            ok = check(rebuilt.recover("lot_check_missing.snap", journal), "stress", "recover from the journal") &&
+                 check(sameLot(lot, rebuilt), "stress", "recovered lot differs");
+            rebuilt.setJournal(nullptr);
+        }
+        if (ok) {
+            std::printf("stress    ok  (%d threads x %d operations, %d cars left, journal replays)\n", THREADS,
+                        OPS, cars);
+        }
+    }
+    std::remove(journalPath);
+    return ok;
+}
+
+// ------------------ recovery: snapshots and journal ------------------
+
+std::vector<unsigned char> readFile(const char* path) {
+    std::vector<unsigned char> bytes;
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) return bytes;
+    unsigned char block[1 << 16];
+    std::size_t n;
+    while ((n = std::fread(block, 1, sizeof(block), file)) > 0) bytes.insert(bytes.end(), block, block + n);
+    std::fclose(file);
+    return bytes;
+}
+
+void writeFile(const char* path, const void* data, std::size_t size) {
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) return;
+    std::fwrite(data, 1, size, file);
+    std::fclose(file);
+}
+
+bool runRecovery() {
+    const char* snapshotPath = "lot_check.snap";
+    const char* journalPath = "lot_check.journal";
+    const char* copyPath = "lot_check_copy.journal";
+    const char* badPath = "lot_check_bad.snap";
+    const int STACKS = 50;
+    const int CAPACITY = 20;
+    std::remove(snapshotPath);
+    std::remove(journalPath);
+
+    WorkloadConfig config;
+    config.numStacks = STACKS;
+    config.stackCapacity = CAPACITY;
+    config.sortsPerHour = 40;
+    config.movesPerHour = 40;
+    WorkloadGenerator generator(config);
+
+    // Journaled run with a checkpoint in the middle; keep every journaled record
+    ParkingLot lot(STACKS, CAPACITY);
+    std::vector<TraceRecord> journaled;
+    std::uint64_t base;
+    {
+        JournalConfig journalConfig;
+        journalConfig.groupCommitMillis = 0;
+        journalConfig.groupCommitRecords = 64;
+        Journal journal(journalPath, STACKS, CAPACITY, journalConfig);
+        if (!check(journal.ok(), "recovery", "create journal")) return false;
+        lot.setJournal(&journal);
+        for (int i = 0; i < 100000; ++i) {
+            TraceRecord record = generator.next();
+            std::uint64_t before = journal.sequence();
+            applyTraceRecord(lot, record);
+            if (journal.sequence() != before) journaled.push_back(record);
+            if (i == 60000 && !check(lot.checkpoint(snapshotPath), "recovery", "checkpoint")) return false;
+        }
+        base = journal.getBaseSequence();
+        if (!check(journal.sync(), "recovery", "journal sync")) return false;
+        lot.setJournal(nullptr);
+    }
+
+    // Full recovery
+    {
+        ParkingLot rebuilt(STACKS, CAPACITY);
+        Journal journal(journalPath, STACKS, CAPACITY);
+        if (!check(rebuilt.recover(snapshotPath, journal), "recovery", "recover") ||
+            !check(sameLot(lot, rebuilt), "recovery", "recovered lot differs")) {
+            return false;
+        }
+        rebuilt.setJournal(nullptr);
+    }
+
+    // Torn tails: every cut recovers to the state after some prefix of the records
+    std::vector<unsigned char> journalBytes = readFile(journalPath);
+    std::mt19937 rng(5);
+    int cuts = 0;
+    for (int t = 0; t < 60; ++t) {
+        std::size_t cut = 28 + rng() % (journalBytes.size() - 28);
+        writeFile(copyPath, journalBytes.data(), cut);
+        ParkingLot rebuilt(STACKS, CAPACITY);
+        Journal journal(copyPath, STACKS, CAPACITY);
+        if (!check(journal.ok() && rebuilt.recover(snapshotPath, journal), "recovery", "recover a torn journal")) {
+            return false;
+        }
+        rebuilt.setJournal(nullptr);
+        std::uint64_t sequence = journal.sequence();
+        if (!check(sequence >= base && sequence <= journaled.size(), "recovery", "torn journal sequence")) {
+            return false;
+        }
+        if (t % 6 == 0) {
+            ParkingLot reference(STACKS, CAPACITY);
+            for (std::uint64_t k = 0; k < sequence; ++k) applyTraceRecord(reference, journaled[k]);
+            if (!check(sameLot(reference, rebuilt), "recovery", "torn journal state")) return false;
+            ++cuts;
+        }
+    }
+    std::remove(copyPath);
+
+    // Snapshot round trip into a lot of another shape, then identical behavior
+    {
+        if (!check(lot.saveSnapshot(snapshotPath), "recovery", "save snapshot")) return false;
+        ParkingLot restored(3, 3);
+        if (!check(restored.loadSnapshot(snapshotPath), "recovery", "load snapshot") ||
+            !check(sameLot(lot, restored), "recovery", "loaded lot differs")) {
+            return false;
+        }
+        for (int i = 0; i < 50000; ++i) {
+            TraceRecord record = generator.next();
+            if (!check(applyTraceRecord(lot, record) == applyTraceRecord(restored, record), "recovery",
+                       "restored lot answers differently")) {
+                return false;
+            }
+        }
+        if (!check(sameLot(lot, restored), "recovery", "restored lot drifted")) return false;
+    }
+
+    // Bad snapshots are rejected and leave the lot as it was
+    {
+        const std::int32_t BOM = 0x01020304;
+        std::int32_t magic;
+        std::memcpy(&magic, "PLSN", sizeof(magic));
+        // queue [7], one lane holding 7 as well
+        const std::int32_t duplicate[] = {magic, 2, BOM, 1, 2, 0, 0, 1, 7, 2, 1, 7};
+        // 2^31 - 1 lanes claimed by an 8-word file
+        const std::int32_t hugeLaneCount[] = {magic, 2, BOM, 0x7fffffff, 5, 0, 0, 0};
+        std::vector<unsigned char> truncated = readFile(snapshotPath);
+        truncated.resize(truncated.size() - sizeof(std::int32_t));
+
+        struct Bad {
+            const void* data;
+            std::size_t size;
+            const char* what;
+        };
+        const Bad bad[] = {{duplicate, sizeof(duplicate), "duplicate car accepted"},
+                           {hugeLaneCount, sizeof(hugeLaneCount), "oversized lane count accepted"},
+                           {truncated.data(), truncated.size(), "truncated snapshot accepted"}};
+        for (const Bad &b : bad) {
+            writeFile(badPath, b.data, b.size);
+            ParkingLot probe(4, 4);
+            probe.addCarToEntrance(1);
+            probe.parkCarInFirstAvailableStack();
+            ParkingLot untouched(4, 4);
+            untouched.addCarToEntrance(1);
+            untouched.parkCarInFirstAvailableStack();
+            if (!check(!probe.loadSnapshot(badPath), "recovery", b.what) ||
+                !check(sameLot(probe, untouched), "recovery", "rejected snapshot changed the lot")) {
+                return false;
+            }
+        }
+        std::remove(badPath);
+    }
+
+    std::remove(snapshotPath);
+    std::remove(journalPath);
+    std::printf("recovery  ok  (%zu journaled records, %d torn tails replayed, 3 bad snapshots refused)\n",
+                journaled.size(), cuts);
+    return true;
+}
+
+// ------------------ pool: cross-thread release ------------------
+
+bool runPool() {
+    const long CARS = 2000000;
+    const int LIVE = 500;
+    std::vector<std::atomic<Car*>> slots(LIVE);
+    for (std::atomic<Car*> &slot : slots) slot.store(nullptr);
+
+    std::size_t slabsBefore = CarPool::slabCount();
+    std::thread arrivals([&slots] {
+        for (long i = 0; i < CARS; ++i) {
+            std::atomic<Car*> &slot = slots[i % LIVE];
+            while (slot.load(std::memory_order_acquire) != nullptr) std::this_thread::yield();
+            slot.store(new Car((int)i), std::memory_order_release);
+        }
+    });
+    std::thread exits([&slots] {
+        for (long i = 0; i < CARS; ++i) {
+            std::atomic<Car*> &slot = slots[i % LIVE];
+            Car* car;
+            while ((car = slot.exchange(nullptr, std::memory_order_acq_rel)) == nullptr) std::this_thread::yield();
+            delete car;
+        }
+    });
+    arrivals.join();
+    exits.join();
+
+    // A few slabs cover the live cars plus the exit thread's capped free list
+    std::size_t grown = CarPool::slabCount() - slabsBefore;
+    if (!check(grown <= 8, "pool", "slabs keep growing when cars are freed on another thread")) {
+        std::printf("  %zu new slabs for %d live cars\n", grown, LIVE);
+        return false;
+    }
+    std::printf("pool      ok  (%ld cars across threads, %zu new slabs)\n", CARS, grown);
+    return true;
+}
+
+// ------------------ queue: lock-free entrance ------------------
+
+const int QUEUE_GATES = 4;
+const int QUEUE_PER_GATE = 100000;
+
+// Gate in the high bits, sequence in the low
+int gateCar(int gate, int i) {
+    return (gate << 24) | i;
+}
+
+// Every gate enqueues its cars in order into a small ring, so it fills and
+// wraps constantly
+void runGates(MpmcQueue &queue, std::vector<std::thread> &threads) {
+    for (int g = 0; g < QUEUE_GATES; ++g) {
+        threads.emplace_back([&queue, g] {
+            for (int i = 0; i < QUEUE_PER_GATE; ++i) {
+                while (!queue.enqueue(gateCar(g, i))) std::this_thread::yield();
+            }
+        });
+    }
+}
+
+// Each worker's cars, in the order it took them: every car seen once overall,
+// and any one gate's cars in increasing order within a worker
+bool deliveredOnceInOrder(const std::vector<std::vector<int>> &seen, const char* what) {
+    std::vector<char> delivered(QUEUE_GATES * QUEUE_PER_GATE, 0);
+    for (const std::vector<int> &mine : seen) {
+        std::vector<int> last(QUEUE_GATES, -1);
+        for (int carId : mine) {
+            int g = carId >> 24;
+            int i = carId & 0xffffff;
+            if (g < 0 || g >= QUEUE_GATES || i >= QUEUE_PER_GATE) return check(false, "queue", what);
+            if (!check(i > last[g] && !delivered[g * QUEUE_PER_GATE + i], "queue", what)) {
+                std::printf("  car %d of gate %d out of order or duplicated\n", i, g);
+                return false;
+            }
+            last[g] = i;
+            delivered[g * QUEUE_PER_GATE + i] = 1;
+        }
+    }
+    return check(std::count(delivered.begin(), delivered.end(), 0) == 0, "queue", what);
+}
+
+bool runQueue() {
+    const int WORKERS = 3;
+    const int total = QUEUE_GATES * QUEUE_PER_GATE;
+
+    // Straight through the queue
+    {
+        MpmcQueue queue(64);
+        std::atomic<int> taken(0);
+        std::vector<std::vector<int>> seen(WORKERS);
+        std::vector<std::thread> threads;
+        runGates(queue, threads);
+        for (int w = 0; w < WORKERS; ++w) {
+            threads.emplace_back([&queue, &taken, &seen, w, total] {
+                int carId;
+                while (taken.load(std::memory_order_relaxed) < total) {
+                    if (queue.dequeue(carId)) {
+                        seen[w].push_back(carId);
+                        taken.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        std::this_thread::yield();
+                    }
+                }
+            });
+        }
+        for (std::thread &t : threads) t.join();
+        if (!deliveredOnceInOrder(seen, "MpmcQueue lost, repeated or reordered a car")) return false;
+        if (!check(queue.isEmpty(), "queue", "MpmcQueue not empty after the run")) return false;
+    }
+
+    // Through the lot: workers admit batches into a concurrent lot's entrance
+    {
+        MpmcQueue queue(64);
+        ParkingLot lot(4, 4, true);
+        std::atomic<int> admitted(0);
+        std::vector<std::thread> threads;
+        runGates(queue, threads);
+        for (int w = 0; w < WORKERS; ++w) {
+            threads.emplace_back([&queue, &lot, &admitted, total] {
+                while (admitted.load(std::memory_order_relaxed) < total) {
+                    int n = lot.admitFromQueue(queue, 32);
+                    if (n == 0) std::this_thread::yield();
+                    admitted.fetch_add(n, std::memory_order_relaxed);
+                }
+            });
+        }
+        for (std::thread &t : threads) t.join();
+
+        // Every car waits in the entrance; one pass over it stands in for one worker
+        std::vector<std::vector<int>> seen(1);
+        for (const Car* car = lot.getEntranceQueue().frontCar(); car != nullptr; car = car->next) {
+            seen[0].push_back(car->carId);
+        }
+        if (!check(admitted.load() == total && (int)seen[0].size() == total, "queue",
+                   "admitFromQueue admitted a different number of cars")) {
+            return false;
+        }
+        // Batches from different workers interleave, so only check exactly once
+        std::sort(seen[0].begin(), seen[0].end());
+        if (!deliveredOnceInOrder(seen, "admitFromQueue lost or repeated a car")) return false;
+        // A car already waiting is dropped as a duplicate, and the queue still drains
+        queue.enqueue(gateCar(0, 0));
+        if (!check(lot.admitFromQueue(queue, 32) == 0 && queue.isEmpty(), "queue",
+                   "admitFromQueue admitted a car already waiting")) {
+            return false;
+        }
+    }
+
+    std::printf("queue     ok  (%d gates x %d cars, %d workers, direct and through admitFromQueue)\n",
+                QUEUE_GATES, QUEUE_PER_GATE, WORKERS);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    const char* which = argc > 1 ? argv[1] : "all";
+    bool all = std::strcmp(which, "all") == 0;
+    bool known = all;
+    bool ok = true;
+
+    if (all || std::strcmp(which, "fuzz") == 0) {
+        known = true;
+        ok = ok && runFuzz();
+    }
+    if (all || std::strcmp(which, "stress") == 0) {
+        known = true;
+        ok = ok && runStress();
+    }
+    if (all || std::strcmp(which, "recovery") == 0) {
+        known = true;
+        ok = ok && runRecovery();
+    }
+    if (all || std::strcmp(which, "pool") == 0) {
+        known = true;
+        ok = ok && runPool();
+    }
+    if (all || std::strcmp(which, "queue") == 0) {
+        known = true;
+        ok = ok && runQueue();
+    }
+    if (!known) {
+        std::fprintf(stderr, "usage: %s [fuzz|stress|recovery|pool|queue]\n", argv[0]);
+        return 2;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,288 @@
+// Replays a binary trace (see Trace.h) against ParkingLot and reports
+// throughput and per-operation latency percentiles, or writes synthetic
+// traces with WorkloadGenerator.
+//
+// Build (from src/):
+//   g++ -std=c++17 -O2 -pthread -o trace_replay trace_replay.cpp Trace.cpp WorkloadGenerator.cpp
+//       CarIndex.cpp CarPool.cpp FreeLaneSet.cpp Journal.cpp LotEvent.cpp MpmcQueue.cpp
+//       ParkingLot.cpp Queue.cpp RingQueue.cpp Stack.cpp ThreadPool.cpp
+// Usage:
+//   trace_replay <trace file>
+//   trace_replay gen <trace file> <ops> [stacks capacity seed]
+//
+// The trace is replayed twice on fresh lots: once untimed for throughput,
+// once timing every operation for the latency table. Replays are
+// deterministic, so both passes see the same lot states.
+
+#include "Trace.h"
+#include "WorkloadGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(_WIN32)
+#define TRACE_NO_MMAP
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Read-only view of a whole file: memory-mapped where available, read into
+// memory otherwise
+class MappedFile {
+private:
+    const unsigned char* bytes;
+    std::size_t length;
+#ifdef TRACE_NO_MMAP
+    std::vector<unsigned char> copy;
+#endif
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+public:
+    explicit MappedFile(const char* path) : bytes(nullptr), length(0) {
+#ifdef TRACE_NO_MMAP
+        std::FILE* f = std::fopen(path, "rb");
+        if (f == nullptr) return;
+        unsigned char block[1 << 16];
+        std::size_t n;
+        while ((n = std::fread(block, 1, sizeof(block), f)) > 0) copy.insert(copy.end(), block, block + n);
+        std::fclose(f);
+        bytes = copy.data();
+        length = copy.size();
+#else
+        int fd = open(path, O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            void* p = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                madvise(p, (std::size_t)info.st_size, MADV_SEQUENTIAL);
+                bytes = static_cast<const unsigned char*>(p);
+                length = (std::size_t)info.st_size;
+            }
+        }
+        close(fd);  // the mapping stays valid
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef TRACE_NO_MMAP
+        if (bytes != nullptr) munmap(const_cast<unsigned char*>(bytes), length);
+#endif
+    }
+
+    const unsigned char* data() const { return bytes; }
+    std::size_t size() const { return length; }
+};
+
+// Log-linear latency histogram: 8 buckets per power of two (within 12.5%)
+class LatencyHistogram {
+private:
+    static const int SUB_BITS = 3;
+    static const int SUB = 1 << SUB_BITS;
+    static const int BUCKETS = 64 * SUB;
+
+    std::vector<unsigned long long> counts;
+    unsigned long long total;
+    unsigned long long maxNs;
+
+    static int bucketOf(unsigned long long ns) {
+        if (ns < (unsigned long long)SUB) return (int)ns;
+        int exponent = SUB_BITS;
+        while ((ns >> (exponent + 1)) != 0) ++exponent;
+        int mantissa = (int)(ns >> (exponent - SUB_BITS)) & (SUB - 1);
+        return (exponent - SUB_BITS + 1) * SUB + mantissa;
+    }
+
+    // Smallest latency that falls into the bucket
+    static unsigned long long lowerBound(int bucket) {
+        if (bucket < SUB) return (unsigned long long)bucket;
+        int exponent = bucket / SUB + SUB_BITS - 1;
+        int mantissa = bucket % SUB;
+        return (unsigned long long)(SUB + mantissa) << (exponent - SUB_BITS);
+    }
+
+public:
+    LatencyHistogram() : counts(BUCKETS, 0), total(0), maxNs(0) {}
+
+    void record(unsigned long long ns) {
+        ++counts[bucketOf(ns)];
+        ++total;
+        if (ns > maxNs) maxNs = ns;
+    }
+
+    void merge(const LatencyHistogram &other) {
+        for (int i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+        total += other.total;
+        if (other.maxNs > maxNs) maxNs = other.maxNs;
+    }
+
+    unsigned long long count() const { return total; }
+    unsigned long long max() const { return maxNs; }
+
+    unsigned long long percentile(double p) const {
+        if (total == 0) return 0;
+        unsigned long long rank = (unsigned long long)(p / 100.0 * (double)(total - 1)) + 1;
+        unsigned long long seen = 0;
+        for (int i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= rank) return lowerBound(i);
+        }
+        return maxNs;
+    }
+};
+
+const char* OP_NAMES[] = {"", "arrive", "park-first", "park-specific", "find", "exit", "sort", "move",
+                          "move-top", "retrieve"};
+const int OP_SLOTS = 10;
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Median cost of one timed empty region, to read the latency table against
+long long timerOverheadNs() {
+    const int SAMPLES = 1001;
+    std::vector<long long> samples(SAMPLES);
+    for (long long &sample : samples) {
+        auto start = std::chrono::steady_clock::now();
+        sample = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+    }
+    std::nth_element(samples.begin(), samples.begin() + SAMPLES / 2, samples.end());
+    return samples[SAMPLES / 2];
+}
+
+void printRow(const char* name, const LatencyHistogram &h, unsigned long long succeeded) {
+    std::printf("%14s %11llu %6.1f%% %8llu %8llu %8llu %8llu %10llu\n", name, h.count(),
+                h.count() ? 100.0 * (double)succeeded / (double)h.count() : 0.0,
+                h.percentile(50), h.percentile(90), h.percentile(99), h.percentile(99.9), h.max());
+}
+
+int generate(const char* path, long long ops, const WorkloadConfig &config) {
+    WorkloadGenerator generator(config);
+    TraceWriter writer(path, config.numStacks, config.stackCapacity);
+    if (!writer.ok()) {
+        std::fprintf(stderr, "cannot write %s\n", path);
+        return 1;
+    }
+    std::vector<unsigned long long> counts(OP_SLOTS, 0);
+    for (long long i = 0; i < ops; ++i) {
+        TraceRecord record = generator.next();
+        writer.write(record);
+        ++counts[(int)record.op];
+    }
+    if (!writer.flush()) {
+        std::fprintf(stderr, "write to %s failed\n", path);
+        return 1;
+    }
+    std::printf("wrote %lld ops for a %dx%d lot covering %.1f simulated hours to %s\n", ops,
+                config.numStacks, config.stackCapacity, generator.clock() / 3600, path);
+    for (int op = 1; op < OP_SLOTS; ++op) {
+        std::printf("%14s %11llu\n", OP_NAMES[op], counts[op]);
+    }
+    return 0;
+}
+
+int replay(const char* path) {
+    MappedFile file(path);
+    if (file.data() == nullptr) {
+        std::fprintf(stderr, "cannot read %s\n", path);
+        return 1;
+    }
+    TraceReader header(file.data(), file.size());
+    if (!header.ok()) {
+        std::fprintf(stderr, "%s is not a version %d trace\n", path, TRACE_VERSION);
+        return 1;
+    }
+    int lanes = header.getNumStacks();
+    int capacity = header.getStackCapacity();
+
+    // Pass 1: throughput
+    unsigned long long ops = 0;
+    {
+        ParkingLot lot(lanes, capacity);
+        TraceReader reader(file.data(), file.size());
+        TraceRecord record;
+        auto start = std::chrono::steady_clock::now();
+        while (reader.next(record)) {
+            applyTraceRecord(lot, record);
+            ++ops;
+        }
+        double seconds = secondsSince(start);
+        if (reader.unknownOp()) {
+            std::fprintf(stderr, "record %llu: unknown op (trace from a newer build?)\n", ops);
+            return 1;
+        }
+        if (reader.truncated()) {
+            std::fprintf(stderr, "warning: trailing bytes after record %llu ignored\n", ops);
+        }
+        std::printf("trace: %s, %dx%d lot, %llu ops, %.2f MB (%.2f bytes/op)\n", path, lanes,
+                    capacity, ops, (double)file.size() / 1e6, ops ? (double)file.size() / (double)ops : 0.0);
+        std::printf("throughput: %.2f M ops/s (%.3f s)\n", seconds > 0 ? (double)ops / seconds / 1e6 : 0.0,
+                    seconds);
+    }
+
+    // Pass 2: latency of every operation
+    std::vector<LatencyHistogram> latency(OP_SLOTS);
+    std::vector<unsigned long long> succeeded(OP_SLOTS, 0);
+    {
+        ParkingLot lot(lanes, capacity);
+        TraceReader reader(file.data(), file.size());
+        TraceRecord record;
+        while (reader.next(record)) {
+            auto start = std::chrono::steady_clock::now();
+            bool ok = applyTraceRecord(lot, record);
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            int op = (int)record.op;
+            latency[op].record((unsigned long long)ns);
+            succeeded[op] += ok;
+        }
+    }
+
+    std::printf("\nlatency in ns (includes about %lld ns of timer overhead):\n", timerOverheadNs());
+    std::printf("%14s %11s %7s %8s %8s %8s %8s %10s\n", "operation", "count", "ok", "p50", "p90", "p99",
+                "p99.9", "max");
+    LatencyHistogram all;
+    unsigned long long allSucceeded = 0;
+    for (int op = 1; op < OP_SLOTS; ++op) {
+        if (latency[op].count() == 0) continue;
+        printRow(OP_NAMES[op], latency[op], succeeded[op]);
+        all.merge(latency[op]);
+        allSucceeded += succeeded[op];
+    }
+    printRow("all", all, allSucceeded);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc == 2) return replay(argv[1]);
+
+    if ((argc == 4 || argc == 7) && std::strcmp(argv[1], "gen") == 0) {
+        WorkloadConfig config;
+        if (argc == 7) {
+            config.numStacks = std::atoi(argv[4]);
+            config.stackCapacity = std::atoi(argv[5]);
+            config.seed = (unsigned)std::strtoul(argv[6], nullptr, 10);
+        }
+        long long ops = std::atoll(argv[3]);
+        if (ops > 0 && config.numStacks > 0 && config.stackCapacity > 0) {
+            return generate(argv[2], ops, config);
+        }
+    }
+    std::fprintf(stderr, "usage: %s <trace file>\n"
+                         "       %s gen <trace file> <ops> [stacks capacity seed]\n", argv[0], argv[0]);
+    return 2;
+}